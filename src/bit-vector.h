@@ -0,0 +1,348 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+// Sequence of bits packed 64 per word, with word-at-a-time bulk operations.
+// Bits past size() in the last word are always zero.
+class bit_vector {
+public:
+  using word_type = uint64_t;
+
+  static constexpr size_t word_bits = 64;
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  class reference {
+  public:
+    // O(1) nothrow
+    operator bool() const noexcept {
+      return (*_word & _mask) != 0;
+    }
+
+    // O(1) nothrow
+    reference& operator=(bool value) noexcept {
+      if (value) {
+        *_word |= _mask;
+      } else {
+        *_word &= ~_mask;
+      }
+      return *this;
+    }
+
+    // O(1) nothrow
+    reference& operator=(const reference& other) noexcept {
+      return *this = static_cast<bool>(other);
+    }
+
+    // O(1) nothrow
+    void flip() noexcept {
+      *_word ^= _mask;
+    }
+
+  private:
+    friend class bit_vector;
+
+    reference(word_type* word, word_type mask) noexcept
+        : _word(word)
+        , _mask(mask) {}
+
+    word_type* _word;
+    word_type _mask;
+  };
+
+  // O(1) nothrow
+  bit_vector() noexcept = default;
+
+  // O(N / 64) strong
+  explicit bit_vector(size_t count, bool value = false);
+
+  // O(N / 64) strong
+  bit_vector(const bit_vector& other) = default;
+
+  // O(1) nothrow
+  bit_vector(bit_vector&& other) noexcept;
+
+  // O(N / 64) strong
+  bit_vector& operator=(const bit_vector& other);
+
+  // O(1) nothrow
+  bit_vector& operator=(bit_vector&& other) noexcept;
+
+  // O(1) nothrow
+  reference operator[](size_t index) noexcept;
+
+  // O(1) nothrow
+  bool operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  bool test(size_t index) const noexcept;
+
+  // O(1) nothrow
+  void set(size_t index, bool value = true) noexcept;
+
+  // O(1) nothrow
+  void reset(size_t index) noexcept;
+
+  // O(1) nothrow
+  void flip(size_t index) noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  size_t capacity() const noexcept;
+
+  // O(N / 64) strong
+  void reserve(size_t new_capacity);
+
+  // O(1)* strong
+  void push_back(bool value);
+
+  // O(1) nothrow, does nothing when empty
+  void pop_back() noexcept;
+
+  // O(1) nothrow
+  void clear() noexcept;
+
+  // O(1) nothrow, the packed words; bits past size() are zero
+  const word_type* words() const noexcept;
+
+  // O(1) nothrow
+  size_t word_count() const noexcept;
+
+  // O(N / 64) nothrow, number of set bits
+  size_t count() const noexcept;
+
+  // O(N / 64) nothrow, index of the first set bit or npos
+  size_t find_first() const noexcept;
+
+  // O(N / 64) nothrow, index of the first set bit after pos or npos
+  size_t find_next(size_t pos) const noexcept;
+
+  // O(N / 64) strong, sizes must match
+  bit_vector& operator&=(const bit_vector& other);
+
+  // O(N / 64) strong, sizes must match
+  bit_vector& operator|=(const bit_vector& other);
+
+  // O(N / 64) strong, sizes must match
+  bit_vector& operator^=(const bit_vector& other);
+
+  // O(N / 64) nothrow
+  friend bool operator==(const bit_vector& lhs, const bit_vector& rhs) noexcept;
+
+private:
+  static size_t words_for(size_t bits) noexcept;
+
+  static word_type mask(size_t index) noexcept;
+
+  void check_same_size(const bit_vector& other) const;
+
+  vector<word_type> _words;
+  size_t _size = 0;
+};
+
+inline bit_vector::bit_vector(size_t count, bool value) {
+  size_t n = words_for(count);
+  _words.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    _words.push_back(value ? ~word_type(0) : word_type(0));
+  }
+  _size = count;
+  if (value && count % word_bits != 0) {
+    _words.back() &= (word_type(1) << (count % word_bits)) - 1;
+  }
+}
+
+inline bit_vector::bit_vector(bit_vector&& other) noexcept
+    : _words(std::move(other._words))
+    , _size(std::exchange(other._size, 0)) {}
+
+inline bit_vector& bit_vector::operator=(const bit_vector& other) {
+  if (this != &other) {
+    bit_vector copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+inline bit_vector& bit_vector::operator=(bit_vector&& other) noexcept {
+  if (this != &other) {
+    _words = std::move(other._words);
+    _size = std::exchange(other._size, 0);
+  }
+  return *this;
+}
+
+inline bit_vector::reference bit_vector::operator[](size_t index) noexcept {
+  return reference(&_words[index / word_bits], mask(index));
+}
+
+inline bool bit_vector::operator[](size_t index) const noexcept {
+  return test(index);
+}
+
+inline bool bit_vector::test(size_t index) const noexcept {
+  return (_words[index / word_bits] & mask(index)) != 0;
+}
+
+inline void bit_vector::set(size_t index, bool value) noexcept {
+  (*this)[index] = value;
+}
+
+inline void bit_vector::reset(size_t index) noexcept {
+  _words[index / word_bits] &= ~mask(index);
+}
+
+inline void bit_vector::flip(size_t index) noexcept {
+  _words[index / word_bits] ^= mask(index);
+}
+
+inline size_t bit_vector::size() const noexcept {
+  return _size;
+}
+
+inline bool bit_vector::empty() const noexcept {
+  return _size == 0;
+}
+
+inline size_t bit_vector::capacity() const noexcept {
+  return _words.capacity() * word_bits;
+}
+
+inline void bit_vector::reserve(size_t new_capacity) {
+  _words.reserve(words_for(new_capacity));
+}
+
+inline void bit_vector::push_back(bool value) {
+  if (_size % word_bits == 0) {
+    _words.push_back(0);
+  }
+  if (value) {
+    _words.back() |= mask(_size);
+  }
+  ++_size;
+}
+
+inline void bit_vector::pop_back() noexcept {
+  if (_size == 0) {
+    return;
+  }
+  --_size;
+  if (_size % word_bits == 0) {
+    _words.pop_back();
+  } else {
+    reset(_size);
+  }
+}
+
+inline void bit_vector::clear() noexcept {
+  _words.clear();
+  _size = 0;
+}
+
+inline const bit_vector::word_type* bit_vector::words() const noexcept {
+  return _words.data();
+}
+
+inline size_t bit_vector::word_count() const noexcept {
+  return _words.size();
+}
+
+inline size_t bit_vector::count() const noexcept {
+  size_t result = 0;
+  for (word_type w : _words) {
+    result += std::popcount(w);
+  }
+  return result;
+}
+
+inline size_t bit_vector::find_first() const noexcept {
+  for (size_t i = 0; i < _words.size(); ++i) {
+    if (_words[i] != 0) {
+      return i * word_bits + std::countr_zero(_words[i]);
+    }
+  }
+  return npos;
+}
+
+inline size_t bit_vector::find_next(size_t pos) const noexcept {
+  if (pos == npos || ++pos >= _size) {
+    return npos;
+  }
+  size_t i = pos / word_bits;
+  word_type w = _words[i] & (~word_type(0) << (pos % word_bits));
+  while (w == 0) {
+    if (++i == _words.size()) {
+      return npos;
+    }
+    w = _words[i];
+  }
+  return i * word_bits + std::countr_zero(w);
+}
+
+inline bit_vector& bit_vector::operator&=(const bit_vector& other) {
+  check_same_size(other);
+  for (size_t i = 0; i < _words.size(); ++i) {
+    _words[i] &= other._words[i];
+  }
+  return *this;
+}
+
+inline bit_vector& bit_vector::operator|=(const bit_vector& other) {
+  check_same_size(other);
+  for (size_t i = 0; i < _words.size(); ++i) {
+    _words[i] |= other._words[i];
+  }
+  return *this;
+}
+
+inline bit_vector& bit_vector::operator^=(const bit_vector& other) {
+  check_same_size(other);
+  for (size_t i = 0; i < _words.size(); ++i) {
+    _words[i] ^= other._words[i];
+  }
+  return *this;
+}
+
+inline bool operator==(const bit_vector& lhs, const bit_vector& rhs) noexcept {
+  return lhs._size == rhs._size && std::equal(lhs._words.begin(), lhs._words.end(), rhs._words.begin());
+}
+
+inline bit_vector operator&(bit_vector lhs, const bit_vector& rhs) {
+  lhs &= rhs;
+  return lhs;
+}
+
+inline bit_vector operator|(bit_vector lhs, const bit_vector& rhs) {
+  lhs |= rhs;
+  return lhs;
+}
+
+inline bit_vector operator^(bit_vector lhs, const bit_vector& rhs) {
+  lhs ^= rhs;
+  return lhs;
+}
+
+inline size_t bit_vector::words_for(size_t bits) noexcept {
+  return (bits + word_bits - 1) / word_bits;
+}
+
+inline bit_vector::word_type bit_vector::mask(size_t index) noexcept {
+  return word_type(1) << (index % word_bits);
+}
+
+inline void bit_vector::check_same_size(const bit_vector& other) const {
+  if (_size != other._size) {
+    throw std::invalid_argument("bit_vector sizes differ");
+  }
+}
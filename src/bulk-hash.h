@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 64-bit hash of a byte range in the style of XXH3: short inputs are mixed in
+// one or two 128-bit multiplies, long ones run four independent lanes over
+// 64-byte stripes so the multiplies overlap. Not cryptographic, and the value
+// depends on the byte order of the platform, so it must not be persisted.
+
+namespace bulk_hash_detail {
+
+inline constexpr uint64_t secret[8] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+    0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull, 0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull,
+};
+
+inline uint64_t read64(const unsigned char* p) noexcept {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t read32(const unsigned char* p) noexcept {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// low ^ high half of the 128-bit product
+inline uint64_t fold(uint64_t a, uint64_t b) noexcept {
+#ifdef __SIZEOF_INT128__
+  __extension__ using uint128 = unsigned __int128;
+  uint128 product = static_cast<uint128>(a) * b;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+  uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+  uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  uint64_t low = (cross << 32) | (lo_lo & 0xffffffff);
+  return low ^ high;
+#endif
+}
+
+inline uint64_t avalanche(uint64_t h) noexcept {
+  h ^= h >> 37;
+  h *= 0x165667919e3779f9ull;
+  h ^= h >> 32;
+  return h;
+}
+
+inline uint64_t mix16(const unsigned char* p, size_t key, uint64_t seed) noexcept {
+  return fold(read64(p) ^ (secret[key % 8] + seed), read64(p + 8) ^ (secret[(key + 1) % 8] - seed));
+}
+
+} // namespace bulk_hash_detail
+
+// O(bytes) nothrow
+inline uint64_t bulk_hash(const void* data, size_t bytes, uint64_t seed = 0) noexcept {
+  using namespace bulk_hash_detail;
+
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  uint64_t length = bytes * 0x9e3779b185ebca87ull;
+  if (bytes == 0) {
+    return avalanche(seed ^ secret[0] ^ secret[1]);
+  }
+  if (bytes <= 3) {
+    uint64_t value = uint64_t(p[0]) << 16 | uint64_t(p[bytes / 2]) << 24 | p[bytes - 1] | bytes << 8;
+    return avalanche(fold(value ^ (secret[0] + seed), secret[1] ^ length));
+  }
+  if (bytes <= 8) {
+    uint64_t value = read32(p) | read32(p + bytes - 4) << 32;
+    return avalanche(fold(value ^ (secret[2] + seed), secret[3] ^ length));
+  }
+  if (bytes <= 16) {
+    uint64_t low = read64(p) ^ (secret[4] + seed);
+    uint64_t high = read64(p + bytes - 8) ^ (secret[5] - seed);
+    return avalanche(length + fold(low, high ^ length));
+  }
+  if (bytes <= 128) {
+    // pairs of 16-byte blocks from both ends, overlapping in the middle
+    uint64_t acc = length;
+    for (size_t i = 0; i * 32 < bytes; ++i) {
+      acc += mix16(p + 16 * i, 2 * i, seed);
+      acc += mix16(p + bytes - 16 * (i + 1), 2 * i + 1, seed);
+    }
+    return avalanche(acc);
+  }
+
+  // four lanes, each folding its 16 bytes of a stripe into its accumulator
+  uint64_t acc[4] = {secret[0] + seed, secret[1] - seed, secret[2] ^ seed, secret[3] + length};
+  size_t stripes = (bytes - 1) / 64;
+  for (size_t s = 0; s < stripes; ++s, p += 64) {
+    for (size_t lane = 0; lane < 4; ++lane) {
+      acc[lane] = fold(read64(p + 16 * lane) ^ acc[lane], read64(p + 16 * lane + 8) ^ secret[lane + 4]);
+    }
+  }
+  // the last 1 to 64 bytes, as a stripe ending at the end of the input
+  p = static_cast<const unsigned char*>(data) + bytes - 64;
+  for (size_t lane = 0; lane < 4; ++lane) {
+    acc[lane] = fold(read64(p + 16 * lane) ^ acc[lane], read64(p + 16 * lane + 8) ^ secret[7 - lane]);
+  }
+  return avalanche(length + fold(acc[0] ^ acc[2], acc[1] ^ acc[3]));
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Background thread that destroys objects handed to it, so tearing down a
+// large vector does not stall the thread that drops it. The thread wakes up
+// for every batch of submissions and destroys the whole batch at once.
+//
+// Destruction then runs on the reclaimer thread: element destructors must not
+// depend on the thread they run on, and buffers from recycling_policy join the
+// reclaimer's cache instead of the releasing thread's.
+class background_reclaimer {
+public:
+  // O(1) strong, starts the thread
+  background_reclaimer();
+
+  background_reclaimer(const background_reclaimer&) = delete;
+  background_reclaimer& operator=(const background_reclaimer&) = delete;
+
+  // O(pending) nothrow, destroys whatever is still queued and stops the thread
+  ~background_reclaimer() noexcept;
+
+  // O(1), the reclaimer used by deferred_release()
+  static background_reclaimer& global();
+
+  // O(1)* nothrow, value is moved out and destroyed in the background; if
+  // queueing it fails, it is destroyed right here instead
+  template <typename T>
+  void release(T value) noexcept;
+
+  // O(pending) nothrow, waits until everything released before the call is destroyed
+  void flush() noexcept;
+
+  // O(1) nothrow, objects released but not destroyed yet
+  size_t pending() const noexcept;
+
+private:
+  struct garbage {
+    virtual ~garbage() = default;
+  };
+
+  template <typename T>
+  struct holder : garbage {
+    explicit holder(T&& from) noexcept
+        : value(std::move(from)) {}
+
+    T value;
+  };
+
+  void run() noexcept;
+
+  mutable std::mutex _mutex;
+  vector<garbage*> _queue;
+  uint64_t _released = 0;
+  std::atomic<uint64_t> _destroyed{0};
+  // bumped on every submission and on stop; the thread sleeps on it
+  std::atomic<uint32_t> _signal{0};
+  std::atomic<bool> _stopping{false};
+  std::thread _thread;
+};
+
+// O(1)* nothrow, hands values to background_reclaimer::global() and leaves it
+// empty; vectors without a buffer are not worth a trip to the other thread
+template <typename T, typename Policy>
+void deferred_release(vector<T, Policy>& values) noexcept;
+
+inline background_reclaimer::background_reclaimer()
+    : _thread([this] { run(); }) {}
+
+inline background_reclaimer::~background_reclaimer() noexcept {
+  _stopping.store(true);
+  _signal.fetch_add(1);
+  _signal.notify_one();
+  _thread.join();
+}
+
+inline background_reclaimer& background_reclaimer::global() {
+  static background_reclaimer reclaimer;
+  return reclaimer;
+}
+
+template <typename T>
+void background_reclaimer::release(T value) noexcept {
+  static_assert(std::is_nothrow_move_constructible_v<T>, "released objects must be nothrow movable");
+
+  garbage* g = new (std::nothrow) holder<T>(std::move(value));
+  if (g == nullptr) {
+    return;
+  }
+  bool queued = false;
+  {
+    std::lock_guard lock(_mutex);
+    try {
+      _queue.push_back(g);
+      ++_released;
+      queued = true;
+    } catch (...) {
+    }
+  }
+  if (!queued) {
+    delete g;
+    return;
+  }
+  _signal.fetch_add(1);
+  _signal.notify_one();
+}
+
+inline void background_reclaimer::flush() noexcept {
+  uint64_t target;
+  {
+    std::lock_guard lock(_mutex);
+    target = _released;
+  }
+  for (uint64_t destroyed = _destroyed.load(); destroyed < target; destroyed = _destroyed.load()) {
+    _destroyed.wait(destroyed);
+  }
+}
+
+inline size_t background_reclaimer::pending() const noexcept {
+  std::lock_guard lock(_mutex);
+  return static_cast<size_t>(_released - _destroyed.load());
+}
+
+inline void background_reclaimer::run() noexcept {
+  vector<garbage*> batch;
+  while (true) {
+    // read before looking at the queue, so a submission in between ends the wait at once
+    uint32_t signal = _signal.load();
+    {
+      // the queue keeps a buffer by trading it with the emptied batch
+      std::lock_guard lock(_mutex);
+      batch.swap(_queue);
+    }
+    if (batch.empty()) {
+      if (_stopping.load()) {
+        return;
+      }
+      _signal.wait(signal);
+      continue;
+    }
+    for (garbage* g : batch) {
+      delete g;
+    }
+    _destroyed.fetch_add(batch.size());
+    _destroyed.notify_all();
+    batch.clear();
+  }
+}
+
+template <typename T, typename Policy>
+void deferred_release(vector<T, Policy>& values) noexcept {
+  if (values.capacity() == 0) {
+    return;
+  }
+  vector<T, Policy> taken(std::move(values));
+  try {
+    // the first call starts the thread; if that fails, taken goes out of scope here
+    background_reclaimer::global().release(std::move(taken));
+  } catch (...) {
+  }
+}
@@ -0,0 +1,373 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// Contiguous vector with free space at both ends: push_front and pop_front are
+// O(1) amortized like their back counterparts, and data() stays one array.
+template <typename T, typename Policy = vector_policy>
+class devector {
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using pointer = T*;
+  using const_pointer = const T*;
+
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  // O(1) nothrow
+  devector() noexcept = default;
+
+  // O(N) strong
+  devector(const devector& other);
+
+  // O(1) nothrow
+  devector(devector&& other) noexcept;
+
+  // O(N) strong
+  devector& operator=(const devector& other);
+
+  // O(1) nothrow
+  devector& operator=(devector&& other) noexcept;
+
+  // O(N) nothrow
+  ~devector() noexcept;
+
+  // O(1) nothrow
+  reference operator[](size_t index) noexcept;
+
+  // O(1) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  reference front() noexcept;
+
+  // O(1) nothrow
+  const_reference front() const noexcept;
+
+  // O(1) nothrow
+  reference back() noexcept;
+
+  // O(1) nothrow
+  const_reference back() const noexcept;
+
+  // O(1) nothrow
+  pointer data() noexcept;
+
+  // O(1) nothrow
+  const_pointer data() const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  size_t capacity() const noexcept;
+
+  // O(1) nothrow, free slots before front()
+  size_t front_free() const noexcept;
+
+  // O(1) nothrow, free slots after back()
+  size_t back_free() const noexcept;
+
+  // O(N) strong, spare slots are split between both ends
+  void reserve(size_t new_capacity);
+
+  // O(1)* strong
+  void push_back(const T& value);
+
+  // O(1)* strong
+  void push_front(const T& value);
+
+  // O(1) nothrow, does nothing when empty
+  void pop_back() noexcept;
+
+  // O(1) nothrow, does nothing when empty
+  void pop_front() noexcept;
+
+  // O(N) nothrow, keeps the buffer and recentres it
+  void clear() noexcept;
+
+  // O(1) nothrow
+  iterator begin() noexcept;
+
+  // O(1) nothrow
+  iterator end() noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(1) nothrow
+  void swap(devector& other) noexcept;
+
+private:
+  // O(N) strong, moves the elements to a new buffer starting at offset;
+  // slot, if given, is constructed from value before anything is moved
+  void reallocate(size_t new_capacity, size_t offset, const T* value, size_t slot);
+
+  // capacity for a buffer that has to fit one more element
+  size_t next_capacity() const noexcept;
+
+  T* _buffer = nullptr;
+  size_t _offset = 0;
+  size_t _size = 0;
+  size_t _capacity = 0;
+};
+
+template <typename T, typename Policy>
+devector<T, Policy>::devector(const devector& other) {
+  if (!other.empty()) {
+    devector copy;
+    copy.reserve(other.size());
+    for (const T& value : other) {
+      copy.push_back(value);
+    }
+    swap(copy);
+  }
+}
+
+template <typename T, typename Policy>
+devector<T, Policy>::devector(devector&& other) noexcept {
+  swap(other);
+}
+
+template <typename T, typename Policy>
+devector<T, Policy>& devector<T, Policy>::operator=(const devector& other) {
+  if (this != &other) {
+    devector copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+devector<T, Policy>& devector<T, Policy>::operator=(devector&& other) noexcept {
+  if (this != &other) {
+    devector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+devector<T, Policy>::~devector() noexcept {
+  std::destroy_n(begin(), _size);
+  if (_buffer != nullptr) {
+    Policy::deallocate(_buffer, _capacity * sizeof(T), alignof(T));
+  }
+}
+
+template <typename T, typename Policy>
+T& devector<T, Policy>::operator[](size_t index) noexcept {
+  return _buffer[_offset + index];
+}
+
+template <typename T, typename Policy>
+const T& devector<T, Policy>::operator[](size_t index) const noexcept {
+  return _buffer[_offset + index];
+}
+
+template <typename T, typename Policy>
+T& devector<T, Policy>::front() noexcept {
+  return _buffer[_offset];
+}
+
+template <typename T, typename Policy>
+const T& devector<T, Policy>::front() const noexcept {
+  return _buffer[_offset];
+}
+
+template <typename T, typename Policy>
+T& devector<T, Policy>::back() noexcept {
+  return _buffer[_offset + _size - 1];
+}
+
+template <typename T, typename Policy>
+const T& devector<T, Policy>::back() const noexcept {
+  return _buffer[_offset + _size - 1];
+}
+
+template <typename T, typename Policy>
+T* devector<T, Policy>::data() noexcept {
+  return _buffer + _offset;
+}
+
+template <typename T, typename Policy>
+const T* devector<T, Policy>::data() const noexcept {
+  return _buffer + _offset;
+}
+
+template <typename T, typename Policy>
+size_t devector<T, Policy>::size() const noexcept {
+  return _size;
+}
+
+template <typename T, typename Policy>
+bool devector<T, Policy>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T, typename Policy>
+size_t devector<T, Policy>::capacity() const noexcept {
+  return _capacity;
+}
+
+template <typename T, typename Policy>
+size_t devector<T, Policy>::front_free() const noexcept {
+  return _offset;
+}
+
+template <typename T, typename Policy>
+size_t devector<T, Policy>::back_free() const noexcept {
+  return _capacity - _offset - _size;
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::reserve(size_t new_capacity) {
+  if (new_capacity > _capacity) {
+    reallocate(new_capacity, (new_capacity - _size) / 2, nullptr, 0);
+  }
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::push_back(const T& value) {
+  if (back_free() == 0) {
+    // centre the elements; the slot right after them receives value
+    size_t new_capacity = next_capacity();
+    size_t offset = (new_capacity - _size - 1) / 2;
+    reallocate(new_capacity, offset, &value, offset + _size);
+  } else {
+    new (end()) T(value);
+  }
+  ++_size;
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::push_front(const T& value) {
+  if (front_free() == 0) {
+    size_t new_capacity = next_capacity();
+    size_t offset = (new_capacity - _size + 1) / 2;
+    reallocate(new_capacity, offset, &value, offset - 1);
+  } else {
+    new (begin() - 1) T(value);
+  }
+  --_offset;
+  ++_size;
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::pop_back() noexcept {
+  if (_size == 0) {
+    return;
+  }
+  back().~T();
+  --_size;
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::pop_front() noexcept {
+  if (_size == 0) {
+    return;
+  }
+  front().~T();
+  ++_offset;
+  --_size;
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::clear() noexcept {
+  std::destroy_n(begin(), _size);
+  _size = 0;
+  _offset = _capacity / 2;
+}
+
+template <typename T, typename Policy>
+T* devector<T, Policy>::begin() noexcept {
+  return data();
+}
+
+template <typename T, typename Policy>
+T* devector<T, Policy>::end() noexcept {
+  return data() + _size;
+}
+
+template <typename T, typename Policy>
+const T* devector<T, Policy>::begin() const noexcept {
+  return data();
+}
+
+template <typename T, typename Policy>
+const T* devector<T, Policy>::end() const noexcept {
+  return data() + _size;
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::swap(devector& other) noexcept {
+  std::swap(_buffer, other._buffer);
+  std::swap(_offset, other._offset);
+  std::swap(_size, other._size);
+  std::swap(_capacity, other._capacity);
+}
+
+template <typename T, typename Policy>
+void devector<T, Policy>::reallocate(size_t new_capacity, size_t offset, const T* value, size_t slot) {
+  // no object may span more than PTRDIFF_MAX bytes
+  if (new_capacity > PTRDIFF_MAX / sizeof(T)) {
+    throw std::length_error("devector: capacity exceeds max_size()");
+  }
+  size_t bytes = new_capacity * sizeof(T);
+  T* buffer = static_cast<T*>(Policy::allocate(bytes, alignof(T)));
+  // value may be one of our own elements, so it is copied while still intact
+  if (value != nullptr) {
+    try {
+      new (buffer + slot) T(*value);
+    } catch (...) {
+      Policy::deallocate(buffer, bytes, alignof(T));
+      throw;
+    }
+  }
+
+  size_t moved = 0;
+  try {
+    for (; moved < _size; ++moved) {
+      new (buffer + offset + moved) T(std::move_if_noexcept((*this)[moved]));
+    }
+  } catch (...) {
+    std::destroy_n(buffer + offset, moved);
+    if (value != nullptr) {
+      buffer[slot].~T();
+    }
+    Policy::deallocate(buffer, bytes, alignof(T));
+    throw;
+  }
+
+  std::destroy_n(begin(), _size);
+  if (_buffer != nullptr) {
+    Policy::deallocate(_buffer, _capacity * sizeof(T), alignof(T));
+  }
+  _buffer = buffer;
+  _offset = offset;
+  _capacity = new_capacity;
+}
+
+template <typename T, typename Policy>
+size_t devector<T, Policy>::next_capacity() const noexcept {
+  // sized from the live elements, so a buffer drained from one end and
+  // refilled at the other does not keep growing
+  return std::max<size_t>(2 * (_size + 1), 8);
+}
@@ -0,0 +1,400 @@
+#pragma once
+
+#include "flat-set.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Sorted-vector map with keys and values in separate vectors, so lookups
+// only touch the densely packed keys.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class flat_map {
+  template <bool Const>
+  class basic_iterator;
+
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using key_compare = Compare;
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  // O(1) nothrow
+  flat_map() = default;
+
+  // O(N log N) strong, pairs of (key, value); the first of equal keys wins
+  template <typename InputIt>
+  flat_map(InputIt first, InputIt last);
+
+  // O(N) strong
+  std::pair<iterator, bool> insert(const Key& key, const Value& value);
+
+  // O(N + M log M) strong, pairs of (key, value); existing keys are kept
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last);
+
+  // O(N + M) strong, [first, last) must be sorted by key and unique (asserted)
+  template <typename InputIt>
+  void insert(sorted_unique_t, InputIt first, InputIt last);
+
+  // O(N) strong, inserts Value() when the key is missing
+  Value& operator[](const Key& key);
+
+  // O(log N) strong, throws std::out_of_range when the key is missing
+  Value& at(const Key& key);
+
+  // O(log N) strong
+  const Value& at(const Key& key) const;
+
+  // O(N) basic, nothrow if assigning Key and Value does not throw
+  size_t erase(const Key& key);
+
+  // O(log N) nothrow
+  iterator find(const Key& key);
+
+  // O(log N) nothrow
+  const_iterator find(const Key& key) const;
+
+  // O(log N) nothrow
+  bool contains(const Key& key) const;
+
+  // O(log N) nothrow
+  size_t count(const Key& key) const;
+
+  // O(1) nothrow
+  iterator begin() noexcept;
+
+  // O(1) nothrow
+  iterator end() noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(N) strong
+  void reserve(size_t new_capacity);
+
+  // O(N) nothrow
+  void clear() noexcept;
+
+  // O(1) nothrow, sorted keys
+  const vector<Key>& keys() const noexcept;
+
+  // O(1) nothrow, values in key order
+  const vector<Value>& values() const noexcept;
+
+private:
+  // O(log N) nothrow, index of the first key not less than key
+  size_t lower_index(const Key& key) const;
+
+  // O(log N) nothrow, index of key or size()
+  size_t find_index(const Key& key) const;
+
+  template <typename Pair>
+  void merge_sorted(const Pair* first, const Pair* last);
+
+  vector<Key> _keys;
+  vector<Value> _values;
+  [[no_unique_address]] Compare _comp;
+};
+
+template <typename Key, typename Value, typename Compare>
+template <bool Const>
+class flat_map<Key, Value, Compare>::basic_iterator {
+  using map_pointer = std::conditional_t<Const, const flat_map*, flat_map*>;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using difference_type = ptrdiff_t;
+  using value_type = std::pair<const Key, Value>;
+  using reference = std::pair<const Key&, std::conditional_t<Const, const Value&, Value&>>;
+
+  basic_iterator() = default;
+
+  // O(1) nothrow, iterator to const_iterator
+  template <bool OtherConst>
+    requires (Const && !OtherConst)
+  basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+      : _map(other._map)
+      , _index(other._index) {}
+
+  // O(1) nothrow
+  reference operator*() const noexcept {
+    return reference(_map->_keys[_index], _map->_values[_index]);
+  }
+
+  // O(1) nothrow
+  const Key& key() const noexcept {
+    return _map->_keys[_index];
+  }
+
+  // O(1) nothrow
+  auto& value() const noexcept {
+    return _map->_values[_index];
+  }
+
+  // O(1) nothrow
+  basic_iterator& operator++() noexcept {
+    ++_index;
+    return *this;
+  }
+
+  // O(1) nothrow
+  basic_iterator operator++(int) noexcept {
+    basic_iterator result = *this;
+    ++_index;
+    return result;
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._index == rhs._index;
+  }
+
+private:
+  friend class flat_map;
+
+  template <bool>
+  friend class basic_iterator;
+
+  basic_iterator(map_pointer map, size_t index) noexcept
+      : _map(map)
+      , _index(index) {}
+
+  map_pointer _map = nullptr;
+  size_t _index = 0;
+};
+
+template <typename Key, typename Value, typename Compare>
+template <typename InputIt>
+flat_map<Key, Value, Compare>::flat_map(InputIt first, InputIt last) {
+  insert(first, last);
+}
+
+template <typename Key, typename Value, typename Compare>
+std::pair<typename flat_map<Key, Value, Compare>::iterator, bool>
+flat_map<Key, Value, Compare>::insert(const Key& key, const Value& value) {
+  size_t index = lower_index(key);
+  if (index != _keys.size() && !_comp(key, _keys[index])) {
+    return {iterator(this, index), false};
+  }
+
+  _keys.insert(_keys.begin() + index, key);
+  try {
+    _values.insert(_values.begin() + index, value);
+  } catch (...) {
+    _keys.erase(_keys.begin() + index);
+    throw;
+  }
+  return {iterator(this, index), true};
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename InputIt>
+void flat_map<Key, Value, Compare>::insert(InputIt first, InputIt last) {
+  vector<std::pair<Key, Value>> incoming;
+  for (; first != last; ++first) {
+    incoming.push_back(*first);
+  }
+  std::stable_sort(incoming.begin(), incoming.end(), [this](const auto& lhs, const auto& rhs) {
+    return _comp(lhs.first, rhs.first);
+  });
+  merge_sorted(incoming.begin(), incoming.end());
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename InputIt>
+void flat_map<Key, Value, Compare>::insert(sorted_unique_t, InputIt first, InputIt last) {
+  vector<std::pair<Key, Value>> incoming;
+  for (; first != last; ++first) {
+    incoming.push_back(*first);
+  }
+  assert(std::adjacent_find(incoming.begin(), incoming.end(), [this](const auto& lhs, const auto& rhs) {
+           return !_comp(lhs.first, rhs.first);
+         }) == incoming.end());
+  merge_sorted(incoming.begin(), incoming.end());
+}
+
+template <typename Key, typename Value, typename Compare>
+Value& flat_map<Key, Value, Compare>::operator[](const Key& key) {
+  return insert(key, Value()).first.value();
+}
+
+template <typename Key, typename Value, typename Compare>
+Value& flat_map<Key, Value, Compare>::at(const Key& key) {
+  size_t index = find_index(key);
+  if (index == _keys.size()) {
+    throw std::out_of_range("flat_map::at");
+  }
+  return _values[index];
+}
+
+template <typename Key, typename Value, typename Compare>
+const Value& flat_map<Key, Value, Compare>::at(const Key& key) const {
+  size_t index = find_index(key);
+  if (index == _keys.size()) {
+    throw std::out_of_range("flat_map::at");
+  }
+  return _values[index];
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t flat_map<Key, Value, Compare>::erase(const Key& key) {
+  size_t index = find_index(key);
+  if (index == _keys.size()) {
+    return 0;
+  }
+  if constexpr (std::is_nothrow_copy_assignable_v<Key>) {
+    // values first: if shifting them throws, the keys are still in step
+    _values.erase(_values.begin() + index);
+    _keys.erase(_keys.begin() + index);
+  } else {
+    // a throwing shift of the keys could not be undone once the values have
+    // shifted, so the remaining keys are copied out first
+    vector<Key> keys;
+    keys.reserve(_keys.size() - 1);
+    for (size_t i = 0; i < _keys.size(); ++i) {
+      if (i != index) {
+        keys.push_back(_keys[i]);
+      }
+    }
+    _values.erase(_values.begin() + index);
+    _keys.swap(keys);
+  }
+  return 1;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename flat_map<Key, Value, Compare>::iterator flat_map<Key, Value, Compare>::find(const Key& key) {
+  return iterator(this, find_index(key));
+}
+
+template <typename Key, typename Value, typename Compare>
+typename flat_map<Key, Value, Compare>::const_iterator flat_map<Key, Value, Compare>::find(const Key& key) const {
+  return const_iterator(this, find_index(key));
+}
+
+template <typename Key, typename Value, typename Compare>
+bool flat_map<Key, Value, Compare>::contains(const Key& key) const {
+  return find_index(key) != _keys.size();
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t flat_map<Key, Value, Compare>::count(const Key& key) const {
+  return contains(key) ? 1 : 0;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename flat_map<Key, Value, Compare>::iterator flat_map<Key, Value, Compare>::begin() noexcept {
+  return iterator(this, 0);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename flat_map<Key, Value, Compare>::iterator flat_map<Key, Value, Compare>::end() noexcept {
+  return iterator(this, _keys.size());
+}
+
+template <typename Key, typename Value, typename Compare>
+typename flat_map<Key, Value, Compare>::const_iterator flat_map<Key, Value, Compare>::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename flat_map<Key, Value, Compare>::const_iterator flat_map<Key, Value, Compare>::end() const noexcept {
+  return const_iterator(this, _keys.size());
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t flat_map<Key, Value, Compare>::size() const noexcept {
+  return _keys.size();
+}
+
+template <typename Key, typename Value, typename Compare>
+bool flat_map<Key, Value, Compare>::empty() const noexcept {
+  return _keys.empty();
+}
+
+template <typename Key, typename Value, typename Compare>
+void flat_map<Key, Value, Compare>::reserve(size_t new_capacity) {
+  _keys.reserve(new_capacity);
+  _values.reserve(new_capacity);
+}
+
+template <typename Key, typename Value, typename Compare>
+void flat_map<Key, Value, Compare>::clear() noexcept {
+  _keys.clear();
+  _values.clear();
+}
+
+template <typename Key, typename Value, typename Compare>
+const vector<Key>& flat_map<Key, Value, Compare>::keys() const noexcept {
+  return _keys;
+}
+
+template <typename Key, typename Value, typename Compare>
+const vector<Value>& flat_map<Key, Value, Compare>::values() const noexcept {
+  return _values;
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t flat_map<Key, Value, Compare>::lower_index(const Key& key) const {
+  return std::lower_bound(_keys.begin(), _keys.end(), key, _comp) - _keys.begin();
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t flat_map<Key, Value, Compare>::find_index(const Key& key) const {
+  size_t index = lower_index(key);
+  if (index != _keys.size() && _comp(key, _keys[index])) {
+    return _keys.size();
+  }
+  return index;
+}
+
+// Same merge as flat_set::merge_sorted, writing keys and values side by side.
+template <typename Key, typename Value, typename Compare>
+template <typename Pair>
+void flat_map<Key, Value, Compare>::merge_sorted(const Pair* first, const Pair* last) {
+  if (first == last) {
+    return;
+  }
+
+  vector<Key> keys;
+  vector<Value> values;
+  keys.reserve(_keys.size() + (last - first));
+  values.reserve(_keys.size() + (last - first));
+
+  size_t i = 0;
+  while (i != _keys.size() || first != last) {
+    if (first == last || (i != _keys.size() && !_comp(first->first, _keys[i]))) {
+      if (keys.empty() || _comp(keys.back(), _keys[i])) {
+        keys.push_back(_keys[i]);
+        values.push_back(_values[i]);
+      }
+      ++i;
+    } else {
+      if (keys.empty() || _comp(keys.back(), first->first)) {
+        keys.push_back(first->first);
+        values.push_back(first->second);
+      }
+      ++first;
+    }
+  }
+
+  _keys = std::move(keys);
+  _values = std::move(values);
+}
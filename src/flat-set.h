@@ -0,0 +1,267 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+// Tag for insert() overloads whose input is already sorted and free of duplicates.
+struct sorted_unique_t {
+  explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+// Sorted-vector set. Lookups are binary searches over one contiguous array;
+// single inserts and erases shift the tail, bulk inserts merge in one pass.
+template <typename T, typename Compare = std::less<T>>
+class flat_set {
+public:
+  using value_type = T;
+  using key_type = T;
+  using key_compare = Compare;
+
+  using const_reference = const T&;
+  using const_pointer = const T*;
+
+  using iterator = const T*;
+  using const_iterator = const T*;
+
+  // O(1) nothrow
+  flat_set() = default;
+
+  // O(N log N) strong
+  template <typename InputIt>
+  flat_set(InputIt first, InputIt last);
+
+  // O(N) strong, [first, last) must be sorted and unique (asserted)
+  template <typename InputIt>
+  flat_set(sorted_unique_t, InputIt first, InputIt last);
+
+  // O(N) strong
+  std::pair<iterator, bool> insert(const T& value);
+
+  // O(N + M log M) strong
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last);
+
+  // O(N + M) strong, [first, last) must be sorted and unique (asserted)
+  template <typename InputIt>
+  void insert(sorted_unique_t, InputIt first, InputIt last);
+
+  // O(N) nothrow(swap)
+  size_t erase(const T& key);
+
+  // O(N) nothrow(swap)
+  iterator erase(const_iterator pos);
+
+  // O(log N) nothrow
+  const_iterator find(const T& key) const;
+
+  // O(log N) nothrow
+  bool contains(const T& key) const;
+
+  // O(log N) nothrow
+  size_t count(const T& key) const;
+
+  // O(log N) nothrow
+  const_iterator lower_bound(const T& key) const;
+
+  // O(log N) nothrow
+  const_iterator upper_bound(const T& key) const;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(N) strong
+  void reserve(size_t new_capacity);
+
+  // O(N) nothrow
+  void clear() noexcept;
+
+  // O(1) nothrow, the underlying sorted storage
+  const vector<T>& sequence() const noexcept;
+
+private:
+  bool equivalent(const T& lhs, const T& rhs) const;
+
+  // O(N), whether [first, last) is sorted and free of equivalent elements
+  bool sorted_unique_range(const T* first, const T* last) const;
+
+  void merge_sorted(const T* first, const T* last);
+
+  vector<T> _data;
+  [[no_unique_address]] Compare _comp;
+};
+
+template <typename T, typename Compare>
+template <typename InputIt>
+flat_set<T, Compare>::flat_set(InputIt first, InputIt last) {
+  insert(first, last);
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+flat_set<T, Compare>::flat_set(sorted_unique_t, InputIt first, InputIt last) {
+  for (; first != last; ++first) {
+    _data.push_back(*first);
+  }
+  assert(sorted_unique_range(_data.begin(), _data.end()));
+}
+
+template <typename T, typename Compare>
+std::pair<typename flat_set<T, Compare>::iterator, bool> flat_set<T, Compare>::insert(const T& value) {
+  const T* pos = lower_bound(value);
+  if (pos != end() && equivalent(*pos, value)) {
+    return {pos, false};
+  }
+  return {_data.insert(pos, value), true};
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+void flat_set<T, Compare>::insert(InputIt first, InputIt last) {
+  vector<T> incoming;
+  for (; first != last; ++first) {
+    incoming.push_back(*first);
+  }
+  // stable, so the first of equivalent incoming elements is the one kept
+  std::stable_sort(incoming.begin(), incoming.end(), _comp);
+  merge_sorted(incoming.begin(), incoming.end());
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+void flat_set<T, Compare>::insert(sorted_unique_t, InputIt first, InputIt last) {
+  vector<T> incoming;
+  for (; first != last; ++first) {
+    incoming.push_back(*first);
+  }
+  assert(sorted_unique_range(incoming.begin(), incoming.end()));
+  merge_sorted(incoming.begin(), incoming.end());
+}
+
+template <typename T, typename Compare>
+size_t flat_set<T, Compare>::erase(const T& key) {
+  const T* pos = find(key);
+  if (pos == end()) {
+    return 0;
+  }
+  _data.erase(pos);
+  return 1;
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::iterator flat_set<T, Compare>::erase(const_iterator pos) {
+  return _data.erase(pos);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::const_iterator flat_set<T, Compare>::find(const T& key) const {
+  const T* pos = lower_bound(key);
+  return pos != end() && equivalent(*pos, key) ? pos : end();
+}
+
+template <typename T, typename Compare>
+bool flat_set<T, Compare>::contains(const T& key) const {
+  return find(key) != end();
+}
+
+template <typename T, typename Compare>
+size_t flat_set<T, Compare>::count(const T& key) const {
+  return contains(key) ? 1 : 0;
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::const_iterator flat_set<T, Compare>::lower_bound(const T& key) const {
+  return std::lower_bound(begin(), end(), key, _comp);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::const_iterator flat_set<T, Compare>::upper_bound(const T& key) const {
+  return std::upper_bound(begin(), end(), key, _comp);
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::const_iterator flat_set<T, Compare>::begin() const noexcept {
+  return _data.begin();
+}
+
+template <typename T, typename Compare>
+typename flat_set<T, Compare>::const_iterator flat_set<T, Compare>::end() const noexcept {
+  return _data.end();
+}
+
+template <typename T, typename Compare>
+size_t flat_set<T, Compare>::size() const noexcept {
+  return _data.size();
+}
+
+template <typename T, typename Compare>
+bool flat_set<T, Compare>::empty() const noexcept {
+  return _data.empty();
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::reserve(size_t new_capacity) {
+  _data.reserve(new_capacity);
+}
+
+template <typename T, typename Compare>
+void flat_set<T, Compare>::clear() noexcept {
+  _data.clear();
+}
+
+template <typename T, typename Compare>
+const vector<T>& flat_set<T, Compare>::sequence() const noexcept {
+  return _data;
+}
+
+template <typename T, typename Compare>
+bool flat_set<T, Compare>::equivalent(const T& lhs, const T& rhs) const {
+  return !_comp(lhs, rhs) && !_comp(rhs, lhs);
+}
+
+template <typename T, typename Compare>
+bool flat_set<T, Compare>::sorted_unique_range(const T* first, const T* last) const {
+  return std::adjacent_find(first, last, [this](const T& lhs, const T& rhs) { return !_comp(lhs, rhs); }) == last;
+}
+
+// Merges a sorted range into the set, keeping the existing element (and then
+// the first incoming one) out of every run of equivalent elements.
+template <typename T, typename Compare>
+void flat_set<T, Compare>::merge_sorted(const T* first, const T* last) {
+  if (first == last) {
+    return;
+  }
+
+  vector<T> result;
+  result.reserve(_data.size() + (last - first));
+
+  const T* it = _data.begin();
+  while (it != _data.end() || first != last) {
+    const T* next;
+    if (first == last || (it != _data.end() && !_comp(*first, *it))) {
+      next = it++;
+    } else {
+      next = first++;
+    }
+    if (result.empty() || _comp(result.back(), *next)) {
+      result.push_back(*next);
+    }
+  }
+
+  _data = std::move(result);
+}
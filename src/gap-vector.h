@@ -0,0 +1,440 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Sequence with a movable gap of free slots kept at the last edit position.
+// Inserting or erasing k positions away from the previous edit costs O(k),
+// so clustered edits around a cursor are O(1) amortized. The elements are
+// always the two contiguous segments before and after the gap.
+template <typename T, typename Policy = vector_policy>
+class gap_vector {
+  template <bool Const>
+  class basic_iterator;
+
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  // O(1) nothrow
+  gap_vector() noexcept = default;
+
+  // O(N) strong
+  gap_vector(const gap_vector& other);
+
+  // O(1) nothrow
+  gap_vector(gap_vector&& other) noexcept;
+
+  // O(N) strong
+  gap_vector& operator=(const gap_vector& other);
+
+  // O(1) nothrow
+  gap_vector& operator=(gap_vector&& other) noexcept;
+
+  // O(N) nothrow
+  ~gap_vector() noexcept;
+
+  // O(1) nothrow
+  reference operator[](size_t index) noexcept;
+
+  // O(1) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  size_t capacity() const noexcept;
+
+  // O(1) nothrow, index the next insert lands at without moving anything
+  size_t gap_position() const noexcept;
+
+  // O(|index - gap_position()|) strong
+  void insert(size_t index, const T& value);
+
+  // O(|index - gap_position()|)* strong
+  void push_back(const T& value);
+
+  // O(|index - gap_position()|) strong
+  void erase(size_t index);
+
+  // O(|index - gap_position()| + count) strong
+  void erase(size_t index, size_t count);
+
+  // O(N) nothrow
+  void clear() noexcept;
+
+  // O(1) nothrow, elements before the gap
+  std::span<T> first_segment() noexcept;
+
+  // O(1) nothrow, elements after the gap
+  std::span<T> second_segment() noexcept;
+
+  // O(1) nothrow
+  std::span<const T> first_segment() const noexcept;
+
+  // O(1) nothrow
+  std::span<const T> second_segment() const noexcept;
+
+  // O(1) nothrow
+  iterator begin() noexcept;
+
+  // O(1) nothrow
+  iterator end() noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(1) nothrow
+  void swap(gap_vector& other) noexcept;
+
+private:
+  // O(|index - gap_position()|) strong
+  void move_gap(size_t index);
+
+  // O(N) strong, reallocates so the gap at index holds at least one slot
+  void grow(size_t index);
+
+  size_t gap_size() const noexcept;
+
+  T* _data = nullptr;
+  size_t _capacity = 0;
+  size_t _gap_begin = 0;
+  size_t _gap_end = 0;
+};
+
+template <typename T, typename Policy>
+template <bool Const>
+class gap_vector<T, Policy>::basic_iterator {
+  using owner_pointer = std::conditional_t<Const, const gap_vector*, gap_vector*>;
+
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using difference_type = ptrdiff_t;
+  using value_type = T;
+  using reference = std::conditional_t<Const, const T&, T&>;
+  using pointer = std::conditional_t<Const, const T*, T*>;
+
+  basic_iterator() = default;
+
+  // O(1) nothrow
+  reference operator*() const noexcept {
+    return (*_owner)[_index];
+  }
+
+  // O(1) nothrow
+  pointer operator->() const noexcept {
+    return &(*_owner)[_index];
+  }
+
+  // O(1) nothrow
+  basic_iterator& operator++() noexcept {
+    ++_index;
+    return *this;
+  }
+
+  // O(1) nothrow
+  basic_iterator operator++(int) noexcept {
+    basic_iterator result = *this;
+    ++_index;
+    return result;
+  }
+
+  // O(1) nothrow
+  basic_iterator& operator--() noexcept {
+    --_index;
+    return *this;
+  }
+
+  // O(1) nothrow
+  basic_iterator operator--(int) noexcept {
+    basic_iterator result = *this;
+    --_index;
+    return result;
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._index == rhs._index;
+  }
+
+private:
+  friend class gap_vector;
+
+  basic_iterator(owner_pointer owner, size_t index) noexcept
+      : _owner(owner)
+      , _index(index) {}
+
+  owner_pointer _owner = nullptr;
+  size_t _index = 0;
+};
+
+template <typename T, typename Policy>
+gap_vector<T, Policy>::gap_vector(const gap_vector& other) {
+  if (other.empty()) {
+    return;
+  }
+  size_t bytes = other.size() * sizeof(T);
+  T* data = static_cast<T*>(Policy::allocate(bytes, alignof(T)));
+  size_t copied = 0;
+  try {
+    for (const T& value : other) {
+      new (data + copied) T(value);
+      ++copied;
+    }
+  } catch (...) {
+    std::destroy_n(data, copied);
+    Policy::deallocate(data, bytes, alignof(T));
+    throw;
+  }
+  _data = data;
+  _capacity = bytes / sizeof(T);
+  _gap_begin = copied;
+  _gap_end = _capacity;
+}
+
+template <typename T, typename Policy>
+gap_vector<T, Policy>::gap_vector(gap_vector&& other) noexcept {
+  swap(other);
+}
+
+template <typename T, typename Policy>
+gap_vector<T, Policy>& gap_vector<T, Policy>::operator=(const gap_vector& other) {
+  if (this != &other) {
+    gap_vector copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+gap_vector<T, Policy>& gap_vector<T, Policy>::operator=(gap_vector&& other) noexcept {
+  if (this != &other) {
+    gap_vector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+gap_vector<T, Policy>::~gap_vector() noexcept {
+  clear();
+  if (_data != nullptr) {
+    Policy::deallocate(_data, _capacity * sizeof(T), alignof(T));
+  }
+}
+
+template <typename T, typename Policy>
+T& gap_vector<T, Policy>::operator[](size_t index) noexcept {
+  return _data[index < _gap_begin ? index : index + gap_size()];
+}
+
+template <typename T, typename Policy>
+const T& gap_vector<T, Policy>::operator[](size_t index) const noexcept {
+  return _data[index < _gap_begin ? index : index + gap_size()];
+}
+
+template <typename T, typename Policy>
+size_t gap_vector<T, Policy>::size() const noexcept {
+  return _capacity - gap_size();
+}
+
+template <typename T, typename Policy>
+bool gap_vector<T, Policy>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename T, typename Policy>
+size_t gap_vector<T, Policy>::capacity() const noexcept {
+  return _capacity;
+}
+
+template <typename T, typename Policy>
+size_t gap_vector<T, Policy>::gap_position() const noexcept {
+  return _gap_begin;
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::insert(size_t index, const T& value) {
+  if (std::less_equal<const T*>()(_data, &value) && std::less<const T*>()(&value, _data + _capacity)) {
+    // value lives in this buffer and may be moved by the gap
+    T copy(value);
+    insert(index, copy);
+    return;
+  }
+  if (gap_size() == 0) {
+    grow(index);
+  } else {
+    move_gap(index);
+  }
+  new (_data + _gap_begin) T(value);
+  ++_gap_begin;
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::push_back(const T& value) {
+  insert(size(), value);
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::erase(size_t index) {
+  erase(index, 1);
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::erase(size_t index, size_t count) {
+  move_gap(index);
+  std::destroy_n(_data + _gap_end, count);
+  _gap_end += count;
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::clear() noexcept {
+  std::destroy_n(_data, _gap_begin);
+  std::destroy_n(_data + _gap_end, _capacity - _gap_end);
+  _gap_begin = 0;
+  _gap_end = _capacity;
+}
+
+template <typename T, typename Policy>
+std::span<T> gap_vector<T, Policy>::first_segment() noexcept {
+  return {_data, _gap_begin};
+}
+
+template <typename T, typename Policy>
+std::span<T> gap_vector<T, Policy>::second_segment() noexcept {
+  return {_data + _gap_end, _capacity - _gap_end};
+}
+
+template <typename T, typename Policy>
+std::span<const T> gap_vector<T, Policy>::first_segment() const noexcept {
+  return {_data, _gap_begin};
+}
+
+template <typename T, typename Policy>
+std::span<const T> gap_vector<T, Policy>::second_segment() const noexcept {
+  return {_data + _gap_end, _capacity - _gap_end};
+}
+
+template <typename T, typename Policy>
+typename gap_vector<T, Policy>::iterator gap_vector<T, Policy>::begin() noexcept {
+  return iterator(this, 0);
+}
+
+template <typename T, typename Policy>
+typename gap_vector<T, Policy>::iterator gap_vector<T, Policy>::end() noexcept {
+  return iterator(this, size());
+}
+
+template <typename T, typename Policy>
+typename gap_vector<T, Policy>::const_iterator gap_vector<T, Policy>::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template <typename T, typename Policy>
+typename gap_vector<T, Policy>::const_iterator gap_vector<T, Policy>::end() const noexcept {
+  return const_iterator(this, size());
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::swap(gap_vector& other) noexcept {
+  std::swap(_data, other._data);
+  std::swap(_capacity, other._capacity);
+  std::swap(_gap_begin, other._gap_begin);
+  std::swap(_gap_end, other._gap_end);
+}
+
+// Elements cross the gap one at a time and the gap follows each of them, so
+// a throwing copy leaves a valid sequence with the same contents behind.
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::move_gap(size_t index) {
+  if (gap_size() == 0) {
+    _gap_begin = _gap_end = index;
+    return;
+  }
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    if (index < _gap_begin) {
+      size_t count = _gap_begin - index;
+      std::memmove(_data + _gap_end - count, _data + index, count * sizeof(T));
+      _gap_begin -= count;
+      _gap_end -= count;
+    } else if (index > _gap_begin) {
+      size_t count = index - _gap_begin;
+      std::memmove(_data + _gap_begin, _data + _gap_end, count * sizeof(T));
+      _gap_begin += count;
+      _gap_end += count;
+    }
+  } else {
+    while (index < _gap_begin) {
+      new (_data + _gap_end - 1) T(std::move_if_noexcept(_data[_gap_begin - 1]));
+      _data[_gap_begin - 1].~T();
+      --_gap_begin;
+      --_gap_end;
+    }
+    while (index > _gap_begin) {
+      new (_data + _gap_begin) T(std::move_if_noexcept(_data[_gap_end]));
+      _data[_gap_end].~T();
+      ++_gap_begin;
+      ++_gap_end;
+    }
+  }
+}
+
+template <typename T, typename Policy>
+void gap_vector<T, Policy>::grow(size_t index) {
+  size_t old_size = size();
+  size_t bytes = std::max<size_t>(2 * _capacity, 16) * sizeof(T);
+  T* data = static_cast<T*>(Policy::allocate(bytes, alignof(T)));
+  size_t capacity = bytes / sizeof(T);
+  size_t tail = old_size - index;
+
+  size_t constructed = 0;
+  try {
+    for (; constructed < index; ++constructed) {
+      new (data + constructed) T(std::move_if_noexcept((*this)[constructed]));
+    }
+    for (; constructed < old_size; ++constructed) {
+      new (data + capacity - tail + (constructed - index)) T(std::move_if_noexcept((*this)[constructed]));
+    }
+  } catch (...) {
+    std::destroy_n(data, std::min(constructed, index));
+    if (constructed > index) {
+      std::destroy_n(data + capacity - tail, constructed - index);
+    }
+    Policy::deallocate(data, bytes, alignof(T));
+    throw;
+  }
+
+  clear();
+  if (_data != nullptr) {
+    Policy::deallocate(_data, _capacity * sizeof(T), alignof(T));
+  }
+  _data = data;
+  _capacity = capacity;
+  _gap_begin = index;
+  _gap_end = capacity - tail;
+}
+
+template <typename T, typename Policy>
+size_t gap_vector<T, Policy>::gap_size() const noexcept {
+  return _gap_end - _gap_begin;
+}
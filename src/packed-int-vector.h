@@ -0,0 +1,268 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+// Append-only sequence of 64-bit integers stored as zigzag varint deltas.
+// Every block_size-th value is a checkpoint kept verbatim together with the
+// offset of its block, so random access decodes at most block_size - 1 deltas.
+// Sorted or slowly changing sequences take one or two bytes per value.
+class packed_int_vector {
+  struct checkpoint {
+    uint64_t value;
+    size_t offset;
+  };
+
+public:
+  using value_type = uint64_t;
+
+  static constexpr size_t block_size = 64;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint64_t;
+    using difference_type = ptrdiff_t;
+    using pointer = const uint64_t*;
+    using reference = uint64_t;
+
+    const_iterator() = default;
+
+    // O(1) nothrow
+    uint64_t operator*() const noexcept {
+      return _value;
+    }
+
+    // O(1) nothrow
+    const_iterator& operator++() noexcept;
+
+    // O(1) nothrow
+    const_iterator operator++(int) noexcept {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+      return lhs._index == rhs._index;
+    }
+
+  private:
+    friend class packed_int_vector;
+
+    const_iterator(const packed_int_vector* owner, size_t index) noexcept;
+
+    const packed_int_vector* _owner = nullptr;
+    size_t _index = 0;
+    size_t _offset = 0;
+    uint64_t _value = 0;
+  };
+
+  // O(1) nothrow
+  packed_int_vector() noexcept = default;
+
+  // O(N) strong
+  packed_int_vector(const packed_int_vector& other) = default;
+
+  // O(1) nothrow
+  packed_int_vector(packed_int_vector&& other) noexcept;
+
+  // O(N) strong
+  packed_int_vector& operator=(const packed_int_vector& other);
+
+  // O(1) nothrow
+  packed_int_vector& operator=(packed_int_vector&& other) noexcept;
+
+  // O(1)* strong
+  void push_back(uint64_t value);
+
+  // O(block_size) nothrow
+  uint64_t operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  uint64_t back() const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  void clear() noexcept;
+
+  // O(N) strong
+  void shrink_to_fit();
+
+  // O(1) nothrow, bytes held by the encoded stream and the checkpoint table
+  size_t memory_usage() const noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(N) strong
+  vector<uint64_t> to_vector() const;
+
+private:
+  static uint64_t zigzag(uint64_t delta) noexcept;
+
+  static uint64_t unzigzag(uint64_t encoded) noexcept;
+
+  static uint64_t read_varint(const uint8_t* bytes, size_t& offset) noexcept;
+
+  vector<uint8_t> _bytes;
+  vector<checkpoint> _checkpoints;
+  size_t _size = 0;
+  uint64_t _last = 0;
+};
+
+inline packed_int_vector::packed_int_vector(packed_int_vector&& other) noexcept
+    : _bytes(std::move(other._bytes))
+    , _checkpoints(std::move(other._checkpoints))
+    , _size(std::exchange(other._size, 0))
+    , _last(std::exchange(other._last, 0)) {}
+
+inline packed_int_vector& packed_int_vector::operator=(const packed_int_vector& other) {
+  if (this != &other) {
+    packed_int_vector copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+inline packed_int_vector& packed_int_vector::operator=(packed_int_vector&& other) noexcept {
+  if (this != &other) {
+    _bytes = std::move(other._bytes);
+    _checkpoints = std::move(other._checkpoints);
+    _size = std::exchange(other._size, 0);
+    _last = std::exchange(other._last, 0);
+  }
+  return *this;
+}
+
+inline void packed_int_vector::push_back(uint64_t value) {
+  if (_size % block_size == 0) {
+    _checkpoints.push_back({value, _bytes.size()});
+  } else {
+    size_t old_size = _bytes.size();
+    try {
+      uint64_t encoded = zigzag(value - _last);
+      while (encoded >= 0x80) {
+        _bytes.push_back(static_cast<uint8_t>(encoded | 0x80));
+        encoded >>= 7;
+      }
+      _bytes.push_back(static_cast<uint8_t>(encoded));
+    } catch (...) {
+      while (_bytes.size() > old_size) {
+        _bytes.pop_back();
+      }
+      throw;
+    }
+  }
+  _last = value;
+  ++_size;
+}
+
+inline uint64_t packed_int_vector::operator[](size_t index) const noexcept {
+  const checkpoint& cp = _checkpoints[index / block_size];
+  uint64_t value = cp.value;
+  size_t offset = cp.offset;
+  for (size_t i = index % block_size; i > 0; --i) {
+    value += unzigzag(read_varint(_bytes.data(), offset));
+  }
+  return value;
+}
+
+inline uint64_t packed_int_vector::back() const noexcept {
+  return _last;
+}
+
+inline size_t packed_int_vector::size() const noexcept {
+  return _size;
+}
+
+inline bool packed_int_vector::empty() const noexcept {
+  return _size == 0;
+}
+
+inline void packed_int_vector::clear() noexcept {
+  _bytes.clear();
+  _checkpoints.clear();
+  _size = 0;
+  _last = 0;
+}
+
+inline void packed_int_vector::shrink_to_fit() {
+  _bytes.shrink_to_fit();
+  _checkpoints.shrink_to_fit();
+}
+
+inline size_t packed_int_vector::memory_usage() const noexcept {
+  return _bytes.capacity() + _checkpoints.capacity() * sizeof(checkpoint);
+}
+
+inline packed_int_vector::const_iterator packed_int_vector::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+inline packed_int_vector::const_iterator packed_int_vector::end() const noexcept {
+  return const_iterator(this, _size);
+}
+
+inline vector<uint64_t> packed_int_vector::to_vector() const {
+  vector<uint64_t> result;
+  result.reserve(_size);
+  for (uint64_t value : *this) {
+    result.push_back(value);
+  }
+  return result;
+}
+
+inline uint64_t packed_int_vector::zigzag(uint64_t delta) noexcept {
+  return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
+
+inline uint64_t packed_int_vector::unzigzag(uint64_t encoded) noexcept {
+  return (encoded >> 1) ^ (~(encoded & 1) + 1);
+}
+
+inline uint64_t packed_int_vector::read_varint(const uint8_t* bytes, size_t& offset) noexcept {
+  uint64_t result = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    uint8_t byte = bytes[offset++];
+    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (byte < 0x80) {
+      return result;
+    }
+  }
+}
+
+inline packed_int_vector::const_iterator::const_iterator(const packed_int_vector* owner, size_t index) noexcept
+    : _owner(owner)
+    , _index(index) {
+  if (index < owner->_size) {
+    _value = owner->_checkpoints[0].value;
+    _offset = 0;
+  }
+}
+
+inline packed_int_vector::const_iterator& packed_int_vector::const_iterator::operator++() noexcept {
+  ++_index;
+  if (_index < _owner->_size) {
+    if (_index % block_size == 0) {
+      const checkpoint& cp = _owner->_checkpoints[_index / block_size];
+      _value = cp.value;
+      _offset = cp.offset;
+    } else {
+      _value += unzigzag(read_varint(_owner->_bytes.data(), _offset));
+    }
+  }
+  return *this;
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+#include "thread-pool.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// Parallel algorithms over the contiguous storage of a vector. The range is
+// split into a few chunks per thread of the pool; inner chunk boundaries fall
+// on cache lines of data() so no two threads write to the same line. Ranges
+// below parallel_min_chunk_bytes per chunk run sequentially on the caller.
+//
+// All of them may be called from inside a pool task. Exceptions thrown by the
+// callbacks are rethrown on the calling thread once every chunk has stopped;
+// the elements are then left in a valid but unspecified state.
+
+inline constexpr size_t parallel_cache_line = 64;
+inline constexpr size_t parallel_min_chunk_bytes = 32 * 1024;
+
+namespace parallel_detail {
+
+// Boundaries of at most `parts` chunks covering [0, count).
+template <typename T>
+vector<size_t> chunk_bounds(const T* data, size_t count, size_t parts) {
+  size_t min_chunk = std::max<size_t>(1, parallel_min_chunk_bytes / sizeof(T));
+  parts = std::max<size_t>(1, std::min(parts, count / min_chunk));
+
+  // elements per cache line, and the index of the first one starting a line
+  size_t line = 1;
+  size_t first = 0;
+  uintptr_t offset = reinterpret_cast<uintptr_t>(data) % parallel_cache_line;
+  if (parallel_cache_line % sizeof(T) == 0 && offset % sizeof(T) == 0) {
+    line = parallel_cache_line / sizeof(T);
+    first = (parallel_cache_line - offset) % parallel_cache_line / sizeof(T);
+  }
+
+  vector<size_t> bounds;
+  bounds.reserve(parts + 1);
+  bounds.push_back(0);
+  for (size_t i = 1; i < parts; ++i) {
+    size_t bound = count / parts * i + count % parts * i / parts;
+    if (bound > first) {
+      bound = first + (bound - first) / line * line;
+    }
+    if (bound > bounds.back()) {
+      bounds.push_back(bound);
+    }
+  }
+  bounds.push_back(count);
+  return bounds;
+}
+
+template <typename T>
+vector<size_t> chunk_bounds(const T* data, size_t count, thread_pool& pool) {
+  // a few chunks per thread even out uneven work; one thread gets a single chunk
+  return chunk_bounds(data, count, pool.concurrency() == 1 ? 1 : 4 * pool.concurrency());
+}
+
+// Calls f(begin, end) for every chunk, the first one on the calling thread.
+template <typename F>
+void for_each_chunk(thread_pool& pool, const vector<size_t>& bounds, F& f) {
+  if (bounds.size() == 2) {
+    f(bounds[0], bounds[1]);
+    return;
+  }
+  task_group group(pool);
+  for (size_t i = 1; i + 1 < bounds.size(); ++i) {
+    group.run([&f, begin = bounds[i], end = bounds[i + 1]] { f(begin, end); });
+  }
+  f(bounds[0], bounds[1]);
+  group.wait();
+}
+
+// Moves the merge of the sorted ranges [first1, last1) and [first2, last2) to
+// out, splitting large merges into independent halves run on group.
+template <typename T, typename Compare>
+void merge(T* first1, T* last1, T* first2, T* last2, T* out, Compare& comp, task_group& group, size_t grain) {
+  while (static_cast<size_t>((last1 - first1) + (last2 - first2)) > grain) {
+    if (last1 - first1 < last2 - first2) {
+      std::swap(first1, first2);
+      std::swap(last1, last2);
+    }
+    T* mid1 = first1 + (last1 - first1) / 2;
+    T* mid2 = std::lower_bound(first2, last2, *mid1, comp);
+    T* out_mid = out + (mid1 - first1) + (mid2 - first2);
+    *out_mid = std::move(*mid1);
+    group.run([=, &comp, &group] { merge(first1, mid1, first2, mid2, out, comp, group, grain); });
+    first1 = mid1 + 1;
+    first2 = mid2;
+    out = out_mid + 1;
+  }
+  std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1), std::make_move_iterator(first2),
+             std::make_move_iterator(last2), out, comp);
+}
+
+// Elements move-constructed from [first, first + count) into memory from
+// Policy, destroyed and freed along with the buffer.
+template <typename T, typename Policy>
+class moved_buffer {
+public:
+  // O(N) basic, the range is left moved-from
+  moved_buffer(T* first, size_t count)
+      : _count(count)
+      , _bytes(count * sizeof(T))
+      , _data(static_cast<T*>(Policy::allocate(_bytes, alignof(T)))) {
+    try {
+      std::uninitialized_move_n(first, count, _data);
+    } catch (...) {
+      Policy::deallocate(_data, _bytes, alignof(T));
+      throw;
+    }
+  }
+
+  moved_buffer(const moved_buffer&) = delete;
+  moved_buffer& operator=(const moved_buffer&) = delete;
+
+  ~moved_buffer() noexcept {
+    std::destroy_n(_data, _count);
+    Policy::deallocate(_data, _bytes, alignof(T));
+  }
+
+  T* data() const noexcept {
+    return _data;
+  }
+
+private:
+  size_t _count;
+  size_t _bytes;
+  T* _data;
+};
+
+} // namespace parallel_detail
+
+// O(N / P) basic, calls f on every element
+template <typename T, typename Policy, typename F>
+void parallel_for_each(vector<T, Policy>& a, F f, thread_pool& pool = thread_pool::global()) {
+  T* data = a.data();
+  auto chunk = [&](size_t begin, size_t end) {
+    std::for_each(data + begin, data + end, f);
+  };
+  parallel_detail::for_each_chunk(pool, parallel_detail::chunk_bounds(data, a.size(), pool), chunk);
+}
+
+// O(N / P) basic, out[i] = f(in[i]); in and out may be the same vector
+template <typename T, typename P1, typename U, typename P2, typename F>
+void parallel_transform(const vector<T, P1>& in, vector<U, P2>& out, F f, thread_pool& pool = thread_pool::global()) {
+  if (in.size() != out.size()) {
+    throw std::invalid_argument("parallel_transform: size mismatch");
+  }
+  const T* src = in.data();
+  U* dst = out.data();
+  auto chunk = [&](size_t begin, size_t end) {
+    std::transform(src + begin, src + end, dst + begin, f);
+  };
+  parallel_detail::for_each_chunk(pool, parallel_detail::chunk_bounds(dst, out.size(), pool), chunk);
+}
+
+// O(N / P + P) strong, op has to be associative; chunks are combined in order
+template <typename T, typename Policy, typename Op = std::plus<>>
+T parallel_reduce(const vector<T, Policy>& a, T init, Op op = Op(), thread_pool& pool = thread_pool::global()) {
+  const T* data = a.data();
+  vector<size_t> bounds = parallel_detail::chunk_bounds(data, a.size(), pool);
+  vector<std::optional<T>> partial;
+  for (size_t i = 1; i < bounds.size(); ++i) {
+    partial.push_back(std::nullopt);
+  }
+
+  auto chunk = [&](size_t begin, size_t end) {
+    if (begin == end) {
+      return;
+    }
+    size_t index = std::lower_bound(bounds.begin(), bounds.end(), begin) - bounds.begin();
+    partial[index] = std::accumulate(data + begin + 1, data + end, data[begin], op);
+  };
+  parallel_detail::for_each_chunk(pool, bounds, chunk);
+
+  for (const std::optional<T>& value : partial) {
+    if (value) {
+      init = op(std::move(init), *value);
+    }
+  }
+  return init;
+}
+
+// O(N / P + P) basic, out[i] = in[0] op ... op in[i]; in and out may be the
+// same vector, op has to be associative
+template <typename T, typename P1, typename P2, typename Op = std::plus<>>
+void parallel_inclusive_scan(const vector<T, P1>& in, vector<T, P2>& out, Op op = Op(),
+                             thread_pool& pool = thread_pool::global()) {
+  if (in.size() != out.size()) {
+    throw std::invalid_argument("parallel_inclusive_scan: size mismatch");
+  }
+  const T* src = in.data();
+  T* dst = out.data();
+  vector<size_t> bounds = parallel_detail::chunk_bounds(dst, out.size(), pool);
+  if (bounds.size() == 2) {
+    std::inclusive_scan(src, src + in.size(), dst, op);
+    return;
+  }
+
+  // totals of every chunk but the last, then the carry into each chunk
+  vector<std::optional<T>> carry;
+  for (size_t i = 1; i < bounds.size(); ++i) {
+    carry.push_back(std::nullopt);
+  }
+  auto total = [&](size_t begin, size_t end) {
+    size_t index = std::lower_bound(bounds.begin(), bounds.end(), begin) - bounds.begin();
+    if (index + 1 < carry.size()) {
+      carry[index + 1] = std::accumulate(src + begin + 1, src + end, src[begin], op);
+    }
+  };
+  parallel_detail::for_each_chunk(pool, bounds, total);
+  for (size_t i = 2; i < carry.size(); ++i) {
+    carry[i] = op(*carry[i - 1], *carry[i]);
+  }
+
+  auto scan = [&](size_t begin, size_t end) {
+    size_t index = std::lower_bound(bounds.begin(), bounds.end(), begin) - bounds.begin();
+    T* last = std::inclusive_scan(src + begin, src + end, dst + begin, op);
+    if (carry[index]) {
+      const T& c = *carry[index];
+      std::transform(dst + begin, last, dst + begin, [&](const T& x) { return op(c, x); });
+    }
+  };
+  parallel_detail::for_each_chunk(pool, bounds, scan);
+}
+
+// O(N log N / P + N) basic: sorts chunks in parallel, then merges them pairwise
+// through a buffer of N elements, each merge split into parallel pieces
+template <typename T, typename Policy, typename Compare = std::less<>>
+void parallel_sort(vector<T, Policy>& a, Compare comp = Compare(), thread_pool& pool = thread_pool::global()) {
+  T* data = a.data();
+  vector<size_t> bounds = parallel_detail::chunk_bounds(data, a.size(), pool);
+  if (bounds.size() == 2) {
+    std::sort(data, data + a.size(), comp);
+    return;
+  }
+
+  auto sort_chunk = [&](size_t begin, size_t end) {
+    std::sort(data + begin, data + end, comp);
+  };
+  parallel_detail::for_each_chunk(pool, bounds, sort_chunk);
+
+  // the sorted chunks move out and the first round merges them back, so the
+  // buffer never holds a copy of an element
+  parallel_detail::moved_buffer<T, Policy> buffer(data, a.size());
+  T* src = buffer.data();
+  T* dst = data;
+  size_t grain = std::max<size_t>(1, parallel_min_chunk_bytes / sizeof(T));
+  while (bounds.size() > 2) {
+    vector<size_t> merged;
+    task_group group(pool);
+    for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+      size_t begin = bounds[i];
+      size_t mid = bounds[i + 1];
+      size_t end = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+      group.run([=, &comp, &group] {
+        parallel_detail::merge(src + begin, src + mid, src + mid, src + end, dst + begin, comp, group, grain);
+      });
+    }
+    merged.push_back(a.size());
+    group.wait();
+    bounds = std::move(merged);
+    std::swap(src, dst);
+  }
+
+  if (src != data) {
+    auto move_back = [&](size_t begin, size_t end) {
+      std::move(src + begin, src + end, data + begin);
+    };
+    parallel_detail::for_each_chunk(pool, parallel_detail::chunk_bounds(data, a.size(), pool), move_back);
+  }
+}
@@ -0,0 +1,562 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+// Immutable sequence stored as a radix-balanced tree of 32-element leaves with
+// a separate tail leaf for the last 1 to 32 elements. Copies share the whole
+// tree, and set, push_back and pop_back copy only the O(log32 N) nodes on the
+// path to the changed element, so many versions of a large vector cost memory
+// proportional to their differences.
+//
+// Nodes are reference counted atomically: versions sharing nodes may be used
+// and destroyed on different threads. A builder obtained from transient()
+// edits nodes it owns alone in place, so a batch of edits copies each node at
+// most once.
+template <typename T>
+class persistent_vector {
+  static constexpr size_t bits = 5;
+  static constexpr size_t width = size_t(1) << bits;
+  static constexpr size_t mask = width - 1;
+
+  struct node {
+    std::atomic<size_t> refs{1};
+  };
+
+  struct leaf : node {
+    leaf() noexcept {}
+
+    ~leaf() {
+      std::destroy_n(items, count);
+    }
+
+    size_t count = 0;
+    union {
+      T items[width];
+    };
+  };
+
+  struct inner : node {
+    // leaves below the lowest level, inner nodes above it; null past the end
+    node* children[width] = {};
+  };
+
+public:
+  class builder;
+
+  using value_type = T;
+
+  using const_reference = const T&;
+
+  // O(1) nothrow
+  persistent_vector() noexcept = default;
+
+  // O(N) strong
+  template <typename Policy>
+  explicit persistent_vector(const vector<T, Policy>& values);
+
+  // O(1) nothrow, shares every node
+  persistent_vector(const persistent_vector& other) noexcept;
+
+  // O(1) nothrow
+  persistent_vector(persistent_vector&& other) noexcept;
+
+  // O(1) nothrow, releases what is no longer shared
+  persistent_vector& operator=(const persistent_vector& other) noexcept;
+
+  // O(1) nothrow
+  persistent_vector& operator=(persistent_vector&& other) noexcept;
+
+  // O(N) nothrow, only the nodes not shared with other versions
+  ~persistent_vector() noexcept;
+
+  // O(log32 N) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(log32 N) strong, copy with the element at index replaced
+  persistent_vector set(size_t index, const T& value) const;
+
+  // O(log32 N) strong, copy with value appended
+  persistent_vector push_back(const T& value) const;
+
+  // O(log32 N) strong, copy without the last element
+  persistent_vector pop_back() const;
+
+  // O(1) nothrow, builder starting from this version
+  builder transient() const noexcept;
+
+  // O(N) strong
+  template <typename Policy = vector_policy>
+  vector<T, Policy> to_vector() const;
+
+  // O(N) calls f with a std::span<const T> for every leaf in order
+  template <typename F>
+  void for_each_chunk(F&& f) const;
+
+  // O(1) nothrow
+  void swap(persistent_vector& other) noexcept;
+
+private:
+  // index of the first element in the tail
+  size_t tail_offset() const noexcept;
+
+  // O(log32 N) strong, the in-place edits behind both the copying operations
+  // and the builder; nodes shared with other versions are copied first
+  void assign(size_t index, const T& value);
+
+  void append(const T& value);
+
+  void remove_last();
+
+  // O(32) strong, the tail made owned by this version alone
+  leaf* own_tail();
+
+  // O(1) nothrow
+  static void retain(node* n) noexcept;
+
+  // drops a reference to n, which is level levels above the leaves
+  static void release(node* n, size_t level) noexcept;
+
+  // O(32) strong, slot made to point to a node owned by this version alone
+  static node* own(node*& slot, size_t level);
+
+  // O(log32 N) strong, a chain of new inner nodes level levels high ending at l
+  static node* new_path(size_t level, leaf* l);
+
+  template <typename F>
+  static void for_each_leaf(const node* n, size_t level, F& f);
+
+  size_t _size = 0;
+  // level of the root above the leaves, a multiple of bits
+  size_t _shift = bits;
+  node* _root = nullptr;
+  leaf* _tail = nullptr;
+};
+
+// Mutable handle for a batch of edits on a persistent_vector. Edits run in
+// place on nodes the builder owns alone; nodes still shared with the version
+// it started from are copied once on first touch.
+template <typename T>
+class persistent_vector<T>::builder {
+public:
+  // O(1) nothrow
+  builder() noexcept = default;
+
+  // O(1) nothrow
+  builder(builder&& other) noexcept = default;
+
+  // O(1) nothrow
+  builder& operator=(builder&& other) noexcept = default;
+
+  // O(log32 N) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(log32 N) strong, O(1) once the path is owned
+  void set(size_t index, const T& value);
+
+  // O(1)* strong
+  void push_back(const T& value);
+
+  // O(1)* strong
+  void pop_back();
+
+  // O(1) nothrow, the edited version; leaves the builder empty
+  persistent_vector persistent() noexcept;
+
+private:
+  friend class persistent_vector;
+
+  explicit builder(const persistent_vector& from) noexcept
+      : _vector(from) {}
+
+  persistent_vector _vector;
+};
+
+template <typename T>
+template <typename Policy>
+persistent_vector<T>::persistent_vector(const vector<T, Policy>& values) {
+  try {
+    for (const T& value : values) {
+      append(value);
+    }
+  } catch (...) {
+    release(_root, _shift);
+    release(_tail, 0);
+    throw;
+  }
+}
+
+template <typename T>
+persistent_vector<T>::persistent_vector(const persistent_vector& other) noexcept
+    : _size(other._size)
+    , _shift(other._shift)
+    , _root(other._root)
+    , _tail(other._tail) {
+  retain(_root);
+  retain(_tail);
+}
+
+template <typename T>
+persistent_vector<T>::persistent_vector(persistent_vector&& other) noexcept {
+  swap(other);
+}
+
+template <typename T>
+persistent_vector<T>& persistent_vector<T>::operator=(const persistent_vector& other) noexcept {
+  persistent_vector copy(other);
+  swap(copy);
+  return *this;
+}
+
+template <typename T>
+persistent_vector<T>& persistent_vector<T>::operator=(persistent_vector&& other) noexcept {
+  if (this != &other) {
+    persistent_vector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T>
+persistent_vector<T>::~persistent_vector() noexcept {
+  release(_root, _shift);
+  release(_tail, 0);
+}
+
+template <typename T>
+const T& persistent_vector<T>::operator[](size_t index) const noexcept {
+  size_t offset = tail_offset();
+  if (index >= offset) {
+    return _tail->items[index - offset];
+  }
+  const node* n = _root;
+  for (size_t level = _shift; level > 0; level -= bits) {
+    n = static_cast<const inner*>(n)->children[index >> level & mask];
+  }
+  return static_cast<const leaf*>(n)->items[index & mask];
+}
+
+template <typename T>
+size_t persistent_vector<T>::size() const noexcept {
+  return _size;
+}
+
+template <typename T>
+bool persistent_vector<T>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T>
+persistent_vector<T> persistent_vector<T>::set(size_t index, const T& value) const {
+  persistent_vector result(*this);
+  result.assign(index, value);
+  return result;
+}
+
+template <typename T>
+persistent_vector<T> persistent_vector<T>::push_back(const T& value) const {
+  persistent_vector result(*this);
+  result.append(value);
+  return result;
+}
+
+template <typename T>
+persistent_vector<T> persistent_vector<T>::pop_back() const {
+  persistent_vector result(*this);
+  result.remove_last();
+  return result;
+}
+
+template <typename T>
+typename persistent_vector<T>::builder persistent_vector<T>::transient() const noexcept {
+  return builder(*this);
+}
+
+template <typename T>
+template <typename Policy>
+vector<T, Policy> persistent_vector<T>::to_vector() const {
+  vector<T, Policy> result;
+  result.reserve(_size);
+  for_each_chunk([&](std::span<const T> chunk) {
+    for (const T& value : chunk) {
+      result.push_back(value);
+    }
+  });
+  return result;
+}
+
+template <typename T>
+template <typename F>
+void persistent_vector<T>::for_each_chunk(F&& f) const {
+  if (_root != nullptr) {
+    for_each_leaf(_root, _shift, f);
+  }
+  if (_tail != nullptr) {
+    f(std::span<const T>(_tail->items, _tail->count));
+  }
+}
+
+template <typename T>
+void persistent_vector<T>::swap(persistent_vector& other) noexcept {
+  std::swap(_size, other._size);
+  std::swap(_shift, other._shift);
+  std::swap(_root, other._root);
+  std::swap(_tail, other._tail);
+}
+
+template <typename T>
+size_t persistent_vector<T>::tail_offset() const noexcept {
+  return _tail == nullptr ? 0 : _size - _tail->count;
+}
+
+template <typename T>
+void persistent_vector<T>::assign(size_t index, const T& value) {
+  size_t offset = tail_offset();
+  if (index >= offset) {
+    own_tail()->items[index - offset] = value;
+    return;
+  }
+
+  // every node copied on the way down is installed right away; it holds the
+  // same values, so a throw part way leaves an equal vector behind
+  node** slot = &_root;
+  for (size_t level = _shift; level > 0; level -= bits) {
+    slot = &static_cast<inner*>(own(*slot, level))->children[index >> level & mask];
+  }
+  static_cast<leaf*>(own(*slot, 0))->items[index & mask] = value;
+}
+
+template <typename T>
+void persistent_vector<T>::append(const T& value) {
+  if (_tail != nullptr && _tail->count < width) {
+    leaf* l = own_tail();
+    std::construct_at(l->items + l->count, value);
+    ++l->count;
+    ++_size;
+    return;
+  }
+
+  std::unique_ptr<leaf> new_tail(new leaf());
+  std::construct_at(new_tail->items, value);
+  new_tail->count = 1;
+  if (_tail == nullptr) {
+    _tail = new_tail.release();
+    _size = 1;
+    return;
+  }
+
+  // the full tail moves into the tree at offset
+  size_t offset = tail_offset();
+  if (_root == nullptr) {
+    _root = new_path(_shift, _tail);
+  } else if (offset == size_t(1) << (_shift + bits)) {
+    std::unique_ptr<inner> new_root(new inner());
+    new_root->children[1] = new_path(_shift, _tail);
+    new_root->children[0] = _root;
+    _root = new_root.release();
+    _shift += bits;
+  } else {
+    node** slot = &_root;
+    size_t level = _shift;
+    for (;; level -= bits) {
+      slot = &static_cast<inner*>(own(*slot, level))->children[offset >> level & mask];
+      if (*slot == nullptr || level == bits) {
+        break;
+      }
+    }
+    *slot = new_path(level - bits, _tail);
+  }
+  _tail = new_tail.release();
+  ++_size;
+}
+
+template <typename T>
+void persistent_vector<T>::remove_last() {
+  if (_size == 1) {
+    release(_tail, 0);
+    _tail = nullptr;
+    _size = 0;
+    return;
+  }
+  if (_tail->count > 1) {
+    leaf* l = own_tail();
+    --l->count;
+    std::destroy_at(l->items + l->count);
+    --_size;
+    return;
+  }
+
+  // the last leaf of the tree becomes the tail; own the path to it first
+  size_t last = tail_offset() - 1;
+  inner* path[sizeof(size_t) * 8 / bits + 1];
+  size_t depth = 0;
+  node** slot = &_root;
+  for (size_t level = _shift; level > 0; level -= bits) {
+    path[depth] = static_cast<inner*>(own(*slot, level));
+    slot = &path[depth++]->children[last >> level & mask];
+  }
+
+  release(_tail, 0);
+  _tail = static_cast<leaf*>(*slot);
+  *slot = nullptr;
+  --_size;
+
+  // inner nodes whose only child was the leaf are empty now
+  size_t level = bits;
+  while (depth > 0 && (last >> level & mask) == 0) {
+    --depth;
+    release(path[depth], level);
+    if (depth > 0) {
+      path[depth - 1]->children[last >> (level + bits) & mask] = nullptr;
+    } else {
+      _root = nullptr;
+      _shift = bits;
+    }
+    level += bits;
+  }
+  if (_root != nullptr && _shift > bits && static_cast<inner*>(_root)->children[1] == nullptr) {
+    inner* old_root = static_cast<inner*>(_root);
+    _root = old_root->children[0];
+    old_root->children[0] = nullptr;
+    release(old_root, _shift);
+    _shift -= bits;
+  }
+}
+
+template <typename T>
+typename persistent_vector<T>::leaf* persistent_vector<T>::own_tail() {
+  node* tail = _tail;
+  leaf* l = static_cast<leaf*>(own(tail, 0));
+  _tail = l;
+  return l;
+}
+
+template <typename T>
+void persistent_vector<T>::retain(node* n) noexcept {
+  if (n != nullptr) {
+    n->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+void persistent_vector<T>::release(node* n, size_t level) noexcept {
+  if (n == nullptr || n->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  if (level == 0) {
+    delete static_cast<leaf*>(n);
+    return;
+  }
+  inner* i = static_cast<inner*>(n);
+  for (node* child : i->children) {
+    release(child, level - bits);
+  }
+  delete i;
+}
+
+template <typename T>
+typename persistent_vector<T>::node* persistent_vector<T>::own(node*& slot, size_t level) {
+  // a node referenced once, from a node this version owns, is reachable only from here
+  if (slot->refs.load(std::memory_order_acquire) == 1) {
+    return slot;
+  }
+
+  node* copy;
+  if (level == 0) {
+    const leaf* from = static_cast<const leaf*>(slot);
+    std::unique_ptr<leaf> l(new leaf());
+    for (; l->count < from->count; ++l->count) {
+      std::construct_at(l->items + l->count, from->items[l->count]);
+    }
+    copy = l.release();
+  } else {
+    inner* i = new inner();
+    std::copy_n(static_cast<const inner*>(slot)->children, width, i->children);
+    for (node* child : i->children) {
+      retain(child);
+    }
+    copy = i;
+  }
+  release(slot, level);
+  slot = copy;
+  return copy;
+}
+
+template <typename T>
+typename persistent_vector<T>::node* persistent_vector<T>::new_path(size_t level, leaf* l) {
+  if (level == 0) {
+    return l;
+  }
+  std::unique_ptr<inner> i(new inner());
+  i->children[0] = new_path(level - bits, l);
+  return i.release();
+}
+
+template <typename T>
+template <typename F>
+void persistent_vector<T>::for_each_leaf(const node* n, size_t level, F& f) {
+  if (level == 0) {
+    const leaf* l = static_cast<const leaf*>(n);
+    f(std::span<const T>(l->items, l->count));
+    return;
+  }
+  for (const node* child : static_cast<const inner*>(n)->children) {
+    if (child == nullptr) {
+      break;
+    }
+    for_each_leaf(child, level - bits, f);
+  }
+}
+
+template <typename T>
+const T& persistent_vector<T>::builder::operator[](size_t index) const noexcept {
+  return _vector[index];
+}
+
+template <typename T>
+size_t persistent_vector<T>::builder::size() const noexcept {
+  return _vector.size();
+}
+
+template <typename T>
+bool persistent_vector<T>::builder::empty() const noexcept {
+  return _vector.empty();
+}
+
+template <typename T>
+void persistent_vector<T>::builder::set(size_t index, const T& value) {
+  _vector.assign(index, value);
+}
+
+template <typename T>
+void persistent_vector<T>::builder::push_back(const T& value) {
+  _vector.append(value);
+}
+
+template <typename T>
+void persistent_vector<T>::builder::pop_back() {
+  _vector.remove_last();
+}
+
+template <typename T>
+persistent_vector<T> persistent_vector<T>::builder::persistent() noexcept {
+  return std::move(_vector);
+}
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// Initial capacity for the vectors constructed at one source location.
+struct capacity_hint {
+  const char* file;
+  uint32_t line;
+  uint32_t column;
+  size_t capacity;
+};
+
+// Learns the final size of vectors per construction site. Each site predicts
+// the largest recent size: a larger sample raises the prediction at once,
+// smaller ones let it decay by 1/8 per sample.
+//
+// Predictions can be written out as a header of capacity_hint values and fed
+// back with seed() in the next build, with or without further learning.
+//
+// A source location is only known at run time, so every thread remembers the
+// sites it has seen in a small cache; only the first construction at a site
+// on a thread takes the lock. Predicting and recording are lock-free.
+class capacity_predictor {
+public:
+  // Learned capacity of one construction site. Sites keep their address for
+  // the lifetime of the predictor, so vectors may hold on to them.
+  struct site_slot {
+    site_slot(std::string_view file, uint32_t line, uint32_t column, size_t capacity) noexcept
+        : file(file)
+        , line(line)
+        , column(column)
+        , capacity(capacity) {}
+
+    // file names outlive the predictor: they come from source_location or
+    // from string literals in a generated header
+    std::string_view file;
+    uint32_t line;
+    uint32_t column;
+    std::atomic<size_t> capacity;
+  };
+
+  // O(1) nothrow
+  capacity_predictor() noexcept;
+
+  capacity_predictor(const capacity_predictor&) = delete;
+  capacity_predictor& operator=(const capacity_predictor&) = delete;
+
+  // O(1), the predictor used by predicted_vector
+  static capacity_predictor& global();
+
+  // O(1) amortized strong, the site for predict() and record()
+  site_slot* site(const std::source_location& location);
+
+  // O(1) nothrow, predicted capacity of a site
+  size_t predict(const site_slot* site) const noexcept;
+
+  // O(1) nothrow, feeds the final size of a vector constructed at site
+  void record(site_slot* site, size_t size) noexcept;
+
+  // O(1) nothrow, record() does nothing while learning is off
+  void set_learning(bool enabled) noexcept;
+
+  // O(hints) basic, sets the predictions of the given sites
+  void seed(std::span<const capacity_hint> hints);
+
+  // O(sites) strong, current predictions
+  vector<capacity_hint> hints() const;
+
+  // O(sites log sites), writes hints() as a header defining vector_capacity_hints
+  void write_header(std::ostream& out) const;
+
+  // O(sites) nothrow, forgets every site; vectors built before keep
+  // reporting to sites nobody reads any more
+  void clear() noexcept;
+
+private:
+  struct key {
+    std::string_view file;
+    uint32_t line;
+    uint32_t column;
+
+    bool operator==(const key&) const = default;
+  };
+
+  struct key_hash {
+    size_t operator()(const key& k) const noexcept;
+  };
+
+  // per-thread entry of the site cache
+  struct cached_site {
+    const capacity_predictor* owner;
+    uint64_t epoch;
+    const char* file;
+    uint32_t line;
+    uint32_t column;
+    site_slot* slot;
+  };
+
+  static constexpr size_t site_cache_size = 64;
+
+  // O(1) amortized strong, slot of a site, created if needed; _mutex must be held
+  site_slot* find_or_add(const key& k, size_t capacity);
+
+  // distinguishes predictors and their generations between clear() calls, so
+  // cached sites of a previous one are never taken for current
+  static uint64_t next_epoch() noexcept;
+
+  mutable std::mutex _mutex;
+  std::unordered_map<key, site_slot*, key_hash> _index;
+  // in order of creation
+  vector<site_slot*> _sites;
+  // never shrinks, see site_slot
+  std::deque<site_slot> _slots;
+  std::atomic<uint64_t> _epoch;
+  std::atomic<bool> _learning{true};
+};
+
+// vector that reserves the capacity predicted for the place it is constructed
+// at and reports its size back when destroyed. Moved-from vectors report nothing.
+template <typename T, typename Policy = vector_policy>
+class predicted_vector : public vector<T, Policy> {
+public:
+  // O(1)* strong
+  explicit predicted_vector(std::source_location location = std::source_location::current());
+
+  // O(N) strong, reports to the site of other
+  predicted_vector(const predicted_vector& other);
+
+  // O(1) nothrow
+  predicted_vector(predicted_vector&& other) noexcept;
+
+  // O(N) strong
+  predicted_vector& operator=(const predicted_vector& other);
+
+  // O(1) nothrow, other stops reporting
+  predicted_vector& operator=(predicted_vector&& other) noexcept;
+
+  // O(N) nothrow
+  ~predicted_vector() noexcept;
+
+private:
+  capacity_predictor::site_slot* _site;
+};
+
+inline capacity_predictor::capacity_predictor() noexcept
+    : _epoch(next_epoch()) {}
+
+inline capacity_predictor& capacity_predictor::global() {
+  static capacity_predictor predictor;
+  return predictor;
+}
+
+inline capacity_predictor::site_slot* capacity_predictor::site(const std::source_location& location) {
+  thread_local cached_site cache[site_cache_size] = {};
+
+  uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+  size_t h = reinterpret_cast<uintptr_t>(location.file_name()) >> 3 ^ location.line() * size_t(0x9e3779b1) ^
+             location.column() * size_t(0x85ebca6b);
+  cached_site& c = cache[h % site_cache_size];
+  if (c.owner == this && c.epoch == epoch && c.file == location.file_name() && c.line == location.line() &&
+      c.column == location.column()) {
+    return c.slot;
+  }
+
+  site_slot* slot;
+  {
+    std::lock_guard lock(_mutex);
+    slot = find_or_add({location.file_name(), location.line(), location.column()}, 0);
+  }
+  c = {this, epoch, location.file_name(), location.line(), location.column(), slot};
+  return slot;
+}
+
+inline size_t capacity_predictor::predict(const site_slot* site) const noexcept {
+  return site->capacity.load(std::memory_order_relaxed);
+}
+
+inline void capacity_predictor::record(site_slot* site, size_t size) noexcept {
+  if (!_learning.load(std::memory_order_relaxed)) {
+    return;
+  }
+  size_t capacity = site->capacity.load(std::memory_order_relaxed);
+  while (!site->capacity.compare_exchange_weak(capacity, std::max(size, capacity - capacity / 8),
+                                               std::memory_order_relaxed)) {
+  }
+}
+
+inline void capacity_predictor::set_learning(bool enabled) noexcept {
+  _learning.store(enabled, std::memory_order_relaxed);
+}
+
+inline void capacity_predictor::seed(std::span<const capacity_hint> hints) {
+  std::lock_guard lock(_mutex);
+  for (const capacity_hint& hint : hints) {
+    site_slot* slot = find_or_add({hint.file, hint.line, hint.column}, hint.capacity);
+    slot->capacity.store(hint.capacity, std::memory_order_relaxed);
+  }
+}
+
+inline vector<capacity_hint> capacity_predictor::hints() const {
+  std::lock_guard lock(_mutex);
+  vector<capacity_hint> result;
+  result.reserve(_sites.size());
+  for (const site_slot* slot : _sites) {
+    result.push_back({slot->file.data(), slot->line, slot->column, slot->capacity.load(std::memory_order_relaxed)});
+  }
+  return result;
+}
+
+inline void capacity_predictor::write_header(std::ostream& out) const {
+  vector<capacity_hint> sites = hints();
+  std::sort(sites.begin(), sites.end(), [](const capacity_hint& lhs, const capacity_hint& rhs) {
+    int order = std::string_view(lhs.file).compare(rhs.file);
+    return order != 0 ? order < 0 : std::pair(lhs.line, lhs.column) < std::pair(rhs.line, rhs.column);
+  });
+
+  out << "#pragma once\n\n#include \"predicted-vector.h\"\n\n#include <array>\n\n";
+  out << "inline constexpr std::array<capacity_hint, " << sites.size() << "> vector_capacity_hints = {{\n";
+  for (const capacity_hint& hint : sites) {
+    out << "    {\"";
+    for (char c : std::string_view(hint.file)) {
+      if (c == '"' || c == '\\') {
+        out << '\\';
+      }
+      out << c;
+    }
+    out << "\", " << hint.line << ", " << hint.column << ", " << hint.capacity << "},\n";
+  }
+  out << "}};\n";
+}
+
+inline void capacity_predictor::clear() noexcept {
+  std::lock_guard lock(_mutex);
+  _index.clear();
+  _sites.clear();
+  _epoch.store(next_epoch(), std::memory_order_relaxed);
+}
+
+inline capacity_predictor::site_slot* capacity_predictor::find_or_add(const key& k, size_t capacity) {
+  auto it = _index.find(k);
+  if (it != _index.end()) {
+    return it->second;
+  }
+  site_slot& slot = _slots.emplace_back(k.file, k.line, k.column, capacity);
+  try {
+    _sites.push_back(&slot);
+    try {
+      _index.emplace(k, &slot);
+    } catch (...) {
+      _sites.pop_back();
+      throw;
+    }
+  } catch (...) {
+    _slots.pop_back();
+    throw;
+  }
+  return &slot;
+}
+
+inline uint64_t capacity_predictor::next_epoch() noexcept {
+  static std::atomic<uint64_t> epochs{0};
+  return epochs.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+inline size_t capacity_predictor::key_hash::operator()(const key& k) const noexcept {
+  size_t h = std::hash<std::string_view>()(k.file);
+  return h ^ ((size_t(k.line) << 16 | k.column) * 0x9e3779b97f4a7c15ull);
+}
+
+template <typename T, typename Policy>
+predicted_vector<T, Policy>::predicted_vector(std::source_location location)
+    : _site(capacity_predictor::global().site(location)) {
+  this->reserve(capacity_predictor::global().predict(_site));
+}
+
+template <typename T, typename Policy>
+predicted_vector<T, Policy>::predicted_vector(const predicted_vector& other)
+    : vector<T, Policy>(other)
+    , _site(other._site) {}
+
+template <typename T, typename Policy>
+predicted_vector<T, Policy>::predicted_vector(predicted_vector&& other) noexcept
+    : vector<T, Policy>(std::move(other))
+    , _site(std::exchange(other._site, nullptr)) {}
+
+template <typename T, typename Policy>
+predicted_vector<T, Policy>& predicted_vector<T, Policy>::operator=(const predicted_vector& other) {
+  vector<T, Policy>::operator=(other);
+  return *this;
+}
+
+template <typename T, typename Policy>
+predicted_vector<T, Policy>& predicted_vector<T, Policy>::operator=(predicted_vector&& other) noexcept {
+  vector<T, Policy>::operator=(std::move(other));
+  other._site = nullptr;
+  return *this;
+}
+
+template <typename T, typename Policy>
+predicted_vector<T, Policy>::~predicted_vector() noexcept {
+  if (_site != nullptr) {
+    capacity_predictor::global().record(_site, this->size());
+  }
+}
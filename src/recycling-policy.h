@@ -0,0 +1,211 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Allocation hooks that keep freed buffers in per-thread freelists bucketed by
+// power-of-two size, so short-lived vectors of similar sizes stop hitting the
+// global allocator. Use as vector<T, recycling_policy>.
+//
+// Requests are rounded up to their bucket and allocate() reports the bucket
+// size, so vector grows into the whole block. Requests above max_block_size or
+// with extended alignment go straight to vector_policy.
+//
+// A buffer may be released on a different thread than it was allocated on; it
+// then joins the releasing thread's cache. Each thread frees its cache on exit;
+// buffers released later on that thread, by thread_local vectors created before
+// the cache or, on the main thread, by static ones, go straight back to the
+// global allocator.
+struct recycling_policy {
+  static constexpr size_t min_block_size = 64;
+  static constexpr size_t max_block_size = size_t(1) << 20;
+
+  // Per-thread counters.
+  struct statistics {
+    size_t hits = 0;     // allocations served from the cache
+    size_t misses = 0;   // allocations that went to the global allocator
+    size_t recycled = 0; // buffers put into the cache
+    size_t released = 0; // buffers handed back to the global allocator
+  };
+
+  // O(1)
+  static void* allocate(size_t& bytes, size_t alignment);
+
+  // O(1) nothrow
+  static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept;
+
+  // O(cached buffers) nothrow, frees everything cached by the calling thread
+  static void trim() noexcept;
+
+  // O(1) nothrow, counters of the calling thread
+  static statistics stats() noexcept;
+
+  // O(1) nothrow, bytes cached by the calling thread
+  static size_t cached_bytes() noexcept;
+
+  // O(1) nothrow, bytes cached by all threads together
+  static size_t total_cached_bytes() noexcept;
+
+  // O(1) nothrow, buffers that would push the total past the limit are freed
+  // instead of cached; the default is 64 MiB
+  static void set_cache_limit(size_t bytes) noexcept;
+
+private:
+  static constexpr size_t bucket_count = std::countr_zero(max_block_size) - std::countr_zero(min_block_size) + 1;
+
+  struct free_block {
+    free_block* next;
+  };
+
+  struct cache {
+    free_block* buckets[bucket_count] = {};
+    size_t bytes = 0;
+    statistics stats;
+
+    ~cache();
+
+    // frees every cached buffer, returns how many there were
+    size_t clear() noexcept;
+  };
+
+  // nullptr once the calling thread has destroyed its cache
+  static cache* local() noexcept;
+
+  static bool cacheable(size_t bytes, size_t alignment) noexcept;
+
+  static size_t bucket_size(size_t bytes) noexcept;
+
+  static size_t bucket_index(size_t size) noexcept;
+
+  // trivially destructible, so it stays readable after the cache is gone
+  inline static thread_local bool _cache_destroyed = false;
+
+  inline static std::atomic<size_t> _total_bytes{0};
+  inline static std::atomic<size_t> _limit{size_t(64) << 20};
+};
+
+inline void* recycling_policy::allocate(size_t& bytes, size_t alignment) {
+  if (!cacheable(bytes, alignment)) {
+    return vector_policy::allocate(bytes, alignment);
+  }
+
+  size_t size = bucket_size(bytes);
+  cache* c = local();
+  if (c != nullptr) {
+    free_block*& head = c->buckets[bucket_index(size)];
+    if (head != nullptr) {
+      free_block* block = head;
+      head = block->next;
+      c->bytes -= size;
+      _total_bytes.fetch_sub(size, std::memory_order_relaxed);
+      ++c->stats.hits;
+      bytes = size;
+      return block;
+    }
+  }
+
+  void* ptr = operator new(size);
+  if (c != nullptr) {
+    ++c->stats.misses;
+  }
+  bytes = size;
+  return ptr;
+}
+
+inline void recycling_policy::deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+  if (!cacheable(bytes, alignment)) {
+    vector_policy::deallocate(ptr, bytes, alignment);
+    return;
+  }
+
+  // bytes is anywhere between the request and the bucket size, both of which
+  // round up to the same bucket
+  size_t size = bucket_size(bytes);
+  cache* c = local();
+  if (c == nullptr) {
+    vector_policy::deallocate(ptr, size, alignment);
+    return;
+  }
+  if (_total_bytes.load(std::memory_order_relaxed) + size > _limit.load(std::memory_order_relaxed)) {
+    ++c->stats.released;
+    vector_policy::deallocate(ptr, size, alignment);
+    return;
+  }
+
+  free_block*& head = c->buckets[bucket_index(size)];
+  head = new (ptr) free_block{head};
+  c->bytes += size;
+  _total_bytes.fetch_add(size, std::memory_order_relaxed);
+  ++c->stats.recycled;
+}
+
+inline void recycling_policy::trim() noexcept {
+  if (cache* c = local()) {
+    c->stats.released += c->clear();
+  }
+}
+
+inline recycling_policy::statistics recycling_policy::stats() noexcept {
+  cache* c = local();
+  return c != nullptr ? c->stats : statistics();
+}
+
+inline size_t recycling_policy::cached_bytes() noexcept {
+  cache* c = local();
+  return c != nullptr ? c->bytes : 0;
+}
+
+inline size_t recycling_policy::total_cached_bytes() noexcept {
+  return _total_bytes.load(std::memory_order_relaxed);
+}
+
+inline void recycling_policy::set_cache_limit(size_t bytes) noexcept {
+  _limit.store(bytes, std::memory_order_relaxed);
+}
+
+inline recycling_policy::cache::~cache() {
+  clear();
+  _cache_destroyed = true;
+}
+
+inline size_t recycling_policy::cache::clear() noexcept {
+  size_t count = 0;
+  for (size_t i = 0; i < bucket_count; ++i) {
+    size_t size = min_block_size << i;
+    while (buckets[i] != nullptr) {
+      free_block* block = buckets[i];
+      buckets[i] = block->next;
+      vector_policy::deallocate(block, size, alignof(free_block));
+      ++count;
+    }
+  }
+  _total_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  bytes = 0;
+  return count;
+}
+
+inline recycling_policy::cache* recycling_policy::local() noexcept {
+  if (_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local cache c;
+  return &c;
+}
+
+inline bool recycling_policy::cacheable(size_t bytes, size_t alignment) noexcept {
+  return bytes <= max_block_size && alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+}
+
+inline size_t recycling_policy::bucket_size(size_t bytes) noexcept {
+  return std::bit_ceil(std::max(bytes, min_block_size));
+}
+
+inline size_t recycling_policy::bucket_index(size_t size) noexcept {
+  return std::countr_zero(size) - std::countr_zero(min_block_size);
+}
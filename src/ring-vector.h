@@ -0,0 +1,440 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Circular buffer with power-of-two capacity: push and pop at both ends are
+// O(1) amortized and indexing is a single mask. Grows like vector.
+template <typename T, typename Policy = vector_policy>
+class ring_vector {
+  template <bool Const>
+  class basic_iterator;
+
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  // O(1) nothrow
+  ring_vector() noexcept = default;
+
+  // O(N) strong
+  ring_vector(const ring_vector& other);
+
+  // O(1) nothrow
+  ring_vector(ring_vector&& other) noexcept;
+
+  // O(N) strong
+  ring_vector& operator=(const ring_vector& other);
+
+  // O(1) nothrow
+  ring_vector& operator=(ring_vector&& other) noexcept;
+
+  // O(N) nothrow
+  ~ring_vector() noexcept;
+
+  // O(1) nothrow
+  reference operator[](size_t index) noexcept;
+
+  // O(1) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  reference front() noexcept;
+
+  // O(1) nothrow
+  const_reference front() const noexcept;
+
+  // O(1) nothrow
+  reference back() noexcept;
+
+  // O(1) nothrow
+  const_reference back() const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  size_t capacity() const noexcept;
+
+  // O(N) strong, capacity is rounded up to a power of two
+  void reserve(size_t new_capacity);
+
+  // O(1)* strong
+  void push_back(const T& value);
+
+  // O(1)* strong, value is left moved-from if growing throws
+  void push_back(T&& value);
+
+  // O(1)* strong
+  void push_front(const T& value);
+
+  // O(1) nothrow, does nothing when empty
+  void pop_back() noexcept;
+
+  // O(1) nothrow, does nothing when empty
+  void pop_front() noexcept;
+
+  // O(N) nothrow
+  void clear() noexcept;
+
+  // O(1) nothrow
+  iterator begin() noexcept;
+
+  // O(1) nothrow
+  iterator end() noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(1) nothrow
+  void swap(ring_vector& other) noexcept;
+
+private:
+  // O(N) strong, rounds new_capacity up to a power of two
+  void reallocate(size_t new_capacity);
+
+  template <typename U>
+  void append(U&& value);
+
+  size_t mask() const noexcept;
+
+  T* _data = nullptr;
+  size_t _head = 0;
+  size_t _size = 0;
+  size_t _capacity = 0;
+};
+
+template <typename T, typename Policy>
+template <bool Const>
+class ring_vector<T, Policy>::basic_iterator {
+  using owner_pointer = std::conditional_t<Const, const ring_vector*, ring_vector*>;
+
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using difference_type = ptrdiff_t;
+  using value_type = T;
+  using reference = std::conditional_t<Const, const T&, T&>;
+  using pointer = std::conditional_t<Const, const T*, T*>;
+
+  basic_iterator() = default;
+
+  // O(1) nothrow
+  reference operator*() const noexcept {
+    return (*_owner)[_index];
+  }
+
+  // O(1) nothrow
+  pointer operator->() const noexcept {
+    return &(*_owner)[_index];
+  }
+
+  // O(1) nothrow
+  basic_iterator& operator++() noexcept {
+    ++_index;
+    return *this;
+  }
+
+  // O(1) nothrow
+  basic_iterator operator++(int) noexcept {
+    basic_iterator result = *this;
+    ++_index;
+    return result;
+  }
+
+  // O(1) nothrow
+  basic_iterator& operator--() noexcept {
+    --_index;
+    return *this;
+  }
+
+  // O(1) nothrow
+  basic_iterator operator--(int) noexcept {
+    basic_iterator result = *this;
+    --_index;
+    return result;
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._index == rhs._index;
+  }
+
+private:
+  friend class ring_vector;
+
+  basic_iterator(owner_pointer owner, size_t index) noexcept
+      : _owner(owner)
+      , _index(index) {}
+
+  owner_pointer _owner = nullptr;
+  size_t _index = 0;
+};
+
+template <typename T, typename Policy>
+ring_vector<T, Policy>::ring_vector(const ring_vector& other) {
+  if (!other.empty()) {
+    ring_vector copy;
+    copy.reserve(other.size());
+    for (const T& value : other) {
+      copy.push_back(value);
+    }
+    swap(copy);
+  }
+}
+
+template <typename T, typename Policy>
+ring_vector<T, Policy>::ring_vector(ring_vector&& other) noexcept {
+  swap(other);
+}
+
+template <typename T, typename Policy>
+ring_vector<T, Policy>& ring_vector<T, Policy>::operator=(const ring_vector& other) {
+  if (this != &other) {
+    ring_vector copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+ring_vector<T, Policy>& ring_vector<T, Policy>::operator=(ring_vector&& other) noexcept {
+  if (this != &other) {
+    ring_vector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+ring_vector<T, Policy>::~ring_vector() noexcept {
+  clear();
+  if (_data != nullptr) {
+    Policy::deallocate(_data, _capacity * sizeof(T), alignof(T));
+  }
+}
+
+template <typename T, typename Policy>
+T& ring_vector<T, Policy>::operator[](size_t index) noexcept {
+  return _data[(_head + index) & mask()];
+}
+
+template <typename T, typename Policy>
+const T& ring_vector<T, Policy>::operator[](size_t index) const noexcept {
+  return _data[(_head + index) & mask()];
+}
+
+template <typename T, typename Policy>
+T& ring_vector<T, Policy>::front() noexcept {
+  return _data[_head];
+}
+
+template <typename T, typename Policy>
+const T& ring_vector<T, Policy>::front() const noexcept {
+  return _data[_head];
+}
+
+template <typename T, typename Policy>
+T& ring_vector<T, Policy>::back() noexcept {
+  return (*this)[_size - 1];
+}
+
+template <typename T, typename Policy>
+const T& ring_vector<T, Policy>::back() const noexcept {
+  return (*this)[_size - 1];
+}
+
+template <typename T, typename Policy>
+size_t ring_vector<T, Policy>::size() const noexcept {
+  return _size;
+}
+
+template <typename T, typename Policy>
+bool ring_vector<T, Policy>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T, typename Policy>
+size_t ring_vector<T, Policy>::capacity() const noexcept {
+  return _capacity;
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::reserve(size_t new_capacity) {
+  if (new_capacity > _capacity) {
+    reallocate(new_capacity);
+  }
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::push_back(const T& value) {
+  append(value);
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::push_back(T&& value) {
+  append(std::move(value));
+}
+
+template <typename T, typename Policy>
+template <typename U>
+void ring_vector<T, Policy>::append(U&& value) {
+  if (_size == _capacity) {
+    // value may live in the old buffer, so construct it before releasing that
+    ring_vector grown;
+    grown.reserve(std::max<size_t>(2 * _capacity, 4));
+    new (grown._data + _size) T(std::forward<U>(value));
+    try {
+      for (size_t i = 0; i < _size; ++i) {
+        new (grown._data + i) T(std::move_if_noexcept((*this)[i]));
+        ++grown._size;
+      }
+    } catch (...) {
+      grown._data[_size].~T();
+      throw;
+    }
+    ++grown._size;
+    swap(grown);
+    return;
+  }
+  new (_data + ((_head + _size) & mask())) T(std::forward<U>(value));
+  ++_size;
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::push_front(const T& value) {
+  if (_size == _capacity) {
+    ring_vector grown;
+    grown.reserve(std::max<size_t>(2 * _capacity, 4));
+    new (grown._data) T(value);
+    try {
+      for (size_t i = 0; i < _size; ++i) {
+        new (grown._data + i + 1) T(std::move_if_noexcept((*this)[i]));
+        ++grown._size;
+      }
+    } catch (...) {
+      std::destroy_n(grown._data + 1, grown._size);
+      grown._size = 0;
+      grown._data[0].~T();
+      throw;
+    }
+    ++grown._size;
+    swap(grown);
+    return;
+  }
+  size_t head = (_head - 1) & mask();
+  new (_data + head) T(value);
+  _head = head;
+  ++_size;
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::pop_back() noexcept {
+  if (_size == 0) {
+    return;
+  }
+  back().~T();
+  --_size;
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::pop_front() noexcept {
+  if (_size == 0) {
+    return;
+  }
+  _data[_head].~T();
+  _head = (_head + 1) & mask();
+  --_size;
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::clear() noexcept {
+  while (_size > 0) {
+    pop_back();
+  }
+  _head = 0;
+}
+
+template <typename T, typename Policy>
+typename ring_vector<T, Policy>::iterator ring_vector<T, Policy>::begin() noexcept {
+  return iterator(this, 0);
+}
+
+template <typename T, typename Policy>
+typename ring_vector<T, Policy>::iterator ring_vector<T, Policy>::end() noexcept {
+  return iterator(this, _size);
+}
+
+template <typename T, typename Policy>
+typename ring_vector<T, Policy>::const_iterator ring_vector<T, Policy>::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template <typename T, typename Policy>
+typename ring_vector<T, Policy>::const_iterator ring_vector<T, Policy>::end() const noexcept {
+  return const_iterator(this, _size);
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::swap(ring_vector& other) noexcept {
+  std::swap(_data, other._data);
+  std::swap(_head, other._head);
+  std::swap(_size, other._size);
+  std::swap(_capacity, other._capacity);
+}
+
+template <typename T, typename Policy>
+void ring_vector<T, Policy>::reallocate(size_t new_capacity) {
+  // no object may span more than PTRDIFF_MAX bytes, and the largest power of
+  // two below that bound is the last capacity that can be rounded up to
+  if (new_capacity > std::bit_floor(size_t(PTRDIFF_MAX) / sizeof(T))) {
+    throw std::length_error("ring_vector: capacity exceeds max_size()");
+  }
+  // the allocator may hand out more, but masking needs exactly a power of two
+  new_capacity = std::bit_ceil(new_capacity);
+  size_t bytes = new_capacity * sizeof(T);
+  T* data = static_cast<T*>(Policy::allocate(bytes, alignof(T)));
+  size_t moved = 0;
+  try {
+    for (; moved < _size; ++moved) {
+      new (data + moved) T(std::move_if_noexcept((*this)[moved]));
+    }
+  } catch (...) {
+    std::destroy_n(data, moved);
+    Policy::deallocate(data, bytes, alignof(T));
+    throw;
+  }
+
+  size_t size = _size;
+  clear();
+  if (_data != nullptr) {
+    Policy::deallocate(_data, _capacity * sizeof(T), alignof(T));
+  }
+  _data = data;
+  _head = 0;
+  _size = size;
+  _capacity = new_capacity;
+}
+
+template <typename T, typename Policy>
+size_t ring_vector<T, Policy>::mask() const noexcept {
+  return _capacity - 1;
+}
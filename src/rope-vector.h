@@ -0,0 +1,692 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <utility>
+
+// Sequence stored as a counted B+-tree of contiguous chunks. Indexing,
+// insert and erase at any position descend the tree in O(log N); iteration
+// walks the chunks through a linked list of leaves.
+//
+// Every chunk but a lone root holds at least ChunkSize / 4 elements, and every
+// inner node but the root at least fanout / 4 children: when an erase leaves a
+// node below that, it merges with a neighbour or, if both would not fit into
+// one node, takes over some of its elements.
+//
+// Splitting, merging and borrowing only move pointers or copy into freshly
+// reserved storage. If such a rebalancing step throws, it is skipped and the
+// tree stays valid (just less balanced); it is retried by a later edit. Erase
+// shifts the rest of a chunk by assignment, so it gives the basic guarantee
+// when assigning T may throw.
+template <typename T, size_t ChunkSize = std::max<size_t>(16, 1024 / sizeof(T))>
+class rope_vector {
+  static_assert(ChunkSize >= 4, "chunks must hold at least four elements");
+
+  static constexpr size_t fanout = 32;
+
+  struct node {
+    explicit node(bool is_leaf) noexcept
+        : is_leaf(is_leaf) {}
+
+    bool is_leaf;
+    size_t count = 0;
+  };
+
+  struct leaf : node {
+    leaf()
+        : node(true) {
+      items.reserve(ChunkSize + 1);
+    }
+
+    vector<T> items;
+    leaf* prev = nullptr;
+    leaf* next = nullptr;
+  };
+
+  struct inner : node {
+    inner()
+        : node(false) {
+      children.reserve(fanout + 1);
+      counts.reserve(fanout + 1);
+    }
+
+    vector<node*> children;
+    vector<size_t> counts;
+  };
+
+  template <bool Const>
+  class basic_iterator;
+
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  static constexpr size_t chunk_size = ChunkSize;
+
+  // O(1) nothrow
+  rope_vector() noexcept = default;
+
+  // O(N log N) strong
+  rope_vector(const rope_vector& other);
+
+  // O(1) nothrow
+  rope_vector(rope_vector&& other) noexcept;
+
+  // O(N log N) strong
+  rope_vector& operator=(const rope_vector& other);
+
+  // O(1) nothrow
+  rope_vector& operator=(rope_vector&& other) noexcept;
+
+  // O(N) nothrow
+  ~rope_vector() noexcept;
+
+  // O(log N) nothrow
+  reference operator[](size_t index) noexcept;
+
+  // O(log N) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(log N + ChunkSize) strong
+  void insert(size_t index, const T& value);
+
+  // O(log N + ChunkSize) strong
+  void push_back(const T& value);
+
+  // O(log N + ChunkSize) basic, nothrow if assigning T does not throw; does
+  // nothing when empty
+  void erase(size_t index);
+
+  // O(N) nothrow
+  void clear() noexcept;
+
+  // O(1) nothrow
+  iterator begin() noexcept;
+
+  // O(1) nothrow
+  iterator end() noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(N) calls f with a std::span<const T> for every chunk in order
+  template <typename F>
+  void for_each_chunk(F&& f) const;
+
+  // O(1) nothrow
+  void swap(rope_vector& other) noexcept;
+
+private:
+  // returns a new right sibling when n had to be split
+  node* insert_into(node* n, size_t index, const T& value);
+
+  void erase_from(node* n, size_t index);
+
+  // O(ChunkSize), nullptr when the split could not be done
+  leaf* split(leaf* l);
+
+  // O(fanout) nothrow
+  inner* split(inner* n) noexcept;
+
+  // brings child i of n back to the minimum occupancy after an erase, by
+  // merging it with a neighbour or by borrowing from one
+  void rebalance(inner* n, size_t i);
+
+  static bool underfull(const node* n) noexcept;
+
+  // O(ChunkSize) nothrow, false when copying failed and nothing changed
+  static bool merge(leaf* left, leaf* right) noexcept;
+
+  static void merge(inner* left, inner* right) noexcept;
+
+  // O(ChunkSize), splits the elements of two neighbours evenly between them;
+  // false when copying failed and nothing changed
+  static bool balance(leaf* left, leaf* right);
+
+  // O(fanout) nothrow
+  static void balance(inner* left, inner* right) noexcept;
+
+  static void destroy(node* n) noexcept;
+
+  // O(fanout) nothrow, child holding index, with index rebased into it
+  static size_t locate(const inner* n, size_t& index) noexcept;
+
+  const leaf* find_leaf(size_t& index) const noexcept;
+
+  node* _root = nullptr;
+  leaf* _first = nullptr;
+};
+
+template <typename T, size_t ChunkSize>
+template <bool Const>
+class rope_vector<T, ChunkSize>::basic_iterator {
+  using leaf_pointer = std::conditional_t<Const, const leaf*, leaf*>;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using difference_type = ptrdiff_t;
+  using value_type = T;
+  using reference = std::conditional_t<Const, const T&, T&>;
+  using pointer = std::conditional_t<Const, const T*, T*>;
+
+  basic_iterator() = default;
+
+  // O(1) nothrow
+  reference operator*() const noexcept {
+    return _leaf->items[_index];
+  }
+
+  // O(1) nothrow
+  pointer operator->() const noexcept {
+    return &_leaf->items[_index];
+  }
+
+  // O(1) nothrow
+  basic_iterator& operator++() noexcept {
+    if (++_index == _leaf->items.size()) {
+      _leaf = _leaf->next;
+      _index = 0;
+    }
+    return *this;
+  }
+
+  // O(1) nothrow
+  basic_iterator operator++(int) noexcept {
+    basic_iterator result = *this;
+    ++*this;
+    return result;
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._leaf == rhs._leaf && lhs._index == rhs._index;
+  }
+
+private:
+  friend class rope_vector;
+
+  basic_iterator(leaf_pointer l, size_t index) noexcept
+      : _leaf(l)
+      , _index(index) {}
+
+  leaf_pointer _leaf = nullptr;
+  size_t _index = 0;
+};
+
+template <typename T, size_t ChunkSize>
+rope_vector<T, ChunkSize>::rope_vector(const rope_vector& other) {
+  try {
+    for (const T& value : other) {
+      push_back(value);
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <typename T, size_t ChunkSize>
+rope_vector<T, ChunkSize>::rope_vector(rope_vector&& other) noexcept {
+  swap(other);
+}
+
+template <typename T, size_t ChunkSize>
+rope_vector<T, ChunkSize>& rope_vector<T, ChunkSize>::operator=(const rope_vector& other) {
+  if (this != &other) {
+    rope_vector copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename T, size_t ChunkSize>
+rope_vector<T, ChunkSize>& rope_vector<T, ChunkSize>::operator=(rope_vector&& other) noexcept {
+  if (this != &other) {
+    rope_vector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T, size_t ChunkSize>
+rope_vector<T, ChunkSize>::~rope_vector() noexcept {
+  clear();
+}
+
+template <typename T, size_t ChunkSize>
+T& rope_vector<T, ChunkSize>::operator[](size_t index) noexcept {
+  return const_cast<leaf*>(find_leaf(index))->items[index];
+}
+
+template <typename T, size_t ChunkSize>
+const T& rope_vector<T, ChunkSize>::operator[](size_t index) const noexcept {
+  return find_leaf(index)->items[index];
+}
+
+template <typename T, size_t ChunkSize>
+size_t rope_vector<T, ChunkSize>::size() const noexcept {
+  return _root == nullptr ? 0 : _root->count;
+}
+
+template <typename T, size_t ChunkSize>
+bool rope_vector<T, ChunkSize>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::insert(size_t index, const T& value) {
+  if (_root == nullptr) {
+    leaf* l = new leaf();
+    _root = _first = l;
+  }
+
+  // a root that may split needs a new root above it; allocate it before touching anything
+  bool root_full = _root->is_leaf ? static_cast<leaf*>(_root)->items.size() >= ChunkSize
+                                  : static_cast<inner*>(_root)->children.size() >= fanout;
+  inner* new_root = root_full ? new inner() : nullptr;
+
+  node* sibling;
+  try {
+    sibling = insert_into(_root, index, value);
+  } catch (...) {
+    delete new_root;
+    throw;
+  }
+
+  if (sibling != nullptr) {
+    new_root->children.push_back(_root);
+    new_root->children.push_back(sibling);
+    new_root->counts.push_back(_root->count);
+    new_root->counts.push_back(sibling->count);
+    new_root->count = _root->count + sibling->count;
+    _root = new_root;
+  } else {
+    delete new_root;
+  }
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::push_back(const T& value) {
+  insert(size(), value);
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::erase(size_t index) {
+  if (_root == nullptr) {
+    return;
+  }
+  erase_from(_root, index);
+  if (_root->count == 0) {
+    clear();
+  } else if (!_root->is_leaf && static_cast<inner*>(_root)->children.size() == 1) {
+    inner* old_root = static_cast<inner*>(_root);
+    _root = old_root->children[0];
+    delete old_root;
+  }
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::clear() noexcept {
+  if (_root != nullptr) {
+    destroy(_root);
+  }
+  _root = nullptr;
+  _first = nullptr;
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::iterator rope_vector<T, ChunkSize>::begin() noexcept {
+  return empty() ? end() : iterator(_first, 0);
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::iterator rope_vector<T, ChunkSize>::end() noexcept {
+  return iterator(nullptr, 0);
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::const_iterator rope_vector<T, ChunkSize>::begin() const noexcept {
+  return empty() ? end() : const_iterator(_first, 0);
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::const_iterator rope_vector<T, ChunkSize>::end() const noexcept {
+  return const_iterator(nullptr, 0);
+}
+
+template <typename T, size_t ChunkSize>
+template <typename F>
+void rope_vector<T, ChunkSize>::for_each_chunk(F&& f) const {
+  for (const leaf* l = _first; l != nullptr; l = l->next) {
+    f(std::span<const T>(l->items.data(), l->items.size()));
+  }
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::swap(rope_vector& other) noexcept {
+  std::swap(_root, other._root);
+  std::swap(_first, other._first);
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::node*
+rope_vector<T, ChunkSize>::insert_into(node* n, size_t index, const T& value) {
+  if (n->is_leaf) {
+    leaf* l = static_cast<leaf*>(n);
+    l->items.insert(l->items.begin() + index, value);
+    ++l->count;
+    return l->items.size() > ChunkSize ? split(l) : nullptr;
+  }
+
+  inner* in = static_cast<inner*>(n);
+  if (in->children.size() == in->children.capacity()) {
+    // only after a split of this node failed earlier
+    in->children.reserve(in->children.size() + 1);
+    in->counts.reserve(in->counts.size() + 1);
+  }
+  size_t i = locate(in, index);
+  node* sibling = insert_into(in->children[i], index, value);
+  ++in->count;
+  in->counts[i] = in->children[i]->count;
+  if (sibling == nullptr) {
+    return nullptr;
+  }
+
+  // children and counts have room for fanout + 1 entries, so these do not reallocate
+  in->children.insert(in->children.begin() + i + 1, sibling);
+  in->counts.insert(in->counts.begin() + i + 1, sibling->count);
+  return in->children.size() > fanout ? split(in) : nullptr;
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::erase_from(node* n, size_t index) {
+  if (n->is_leaf) {
+    leaf* l = static_cast<leaf*>(n);
+    l->items.erase(l->items.begin() + index);
+    --l->count;
+    return;
+  }
+
+  inner* in = static_cast<inner*>(n);
+  size_t i = locate(in, index);
+  erase_from(in->children[i], index);
+  --in->count;
+  in->counts[i] = in->children[i]->count;
+  rebalance(in, i);
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::leaf* rope_vector<T, ChunkSize>::split(leaf* l) {
+  size_t half = l->items.size() / 2;
+  leaf* right = nullptr;
+  try {
+    right = new leaf();
+    for (size_t i = half; i < l->items.size(); ++i) {
+      right->items.push_back(l->items[i]);
+    }
+  } catch (...) {
+    delete right;
+    return nullptr;
+  }
+
+  // erasing the tail only destroys elements
+  l->items.erase(l->items.begin() + half, l->items.end());
+  l->count = l->items.size();
+  right->count = right->items.size();
+
+  right->prev = l;
+  right->next = l->next;
+  if (l->next != nullptr) {
+    l->next->prev = right;
+  }
+  l->next = right;
+  return right;
+}
+
+template <typename T, size_t ChunkSize>
+typename rope_vector<T, ChunkSize>::inner* rope_vector<T, ChunkSize>::split(inner* n) noexcept {
+  inner* right;
+  try {
+    right = new inner();
+  } catch (...) {
+    return nullptr;
+  }
+
+  size_t half = n->children.size() / 2;
+  for (size_t i = half; i < n->children.size(); ++i) {
+    right->children.push_back(n->children[i]);
+    right->counts.push_back(n->counts[i]);
+    right->count += n->counts[i];
+  }
+  n->children.erase(n->children.begin() + half, n->children.end());
+  n->counts.erase(n->counts.begin() + half, n->counts.end());
+  n->count -= right->count;
+  return right;
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::rebalance(inner* n, size_t i) {
+  node* child = n->children[i];
+  if (child->count == 0) {
+    if (child->is_leaf) {
+      leaf* l = static_cast<leaf*>(child);
+      if (l->prev != nullptr) {
+        l->prev->next = l->next;
+      } else {
+        _first = l->next;
+      }
+      if (l->next != nullptr) {
+        l->next->prev = l->prev;
+      }
+    }
+    destroy(child);
+    n->children.erase(n->children.begin() + i);
+    n->counts.erase(n->counts.begin() + i);
+    return;
+  }
+
+  if (n->children.size() < 2 || !underfull(child)) {
+    return;
+  }
+
+  // the left neighbour if there is one, the right one otherwise
+  size_t left = i > 0 ? i - 1 : i;
+  node* a = n->children[left];
+  node* b = n->children[left + 1];
+  bool merged = false;
+  if (a->is_leaf) {
+    leaf* la = static_cast<leaf*>(a);
+    leaf* lb = static_cast<leaf*>(b);
+    if (la->items.size() + lb->items.size() <= ChunkSize) {
+      merged = merge(la, lb);
+    } else {
+      balance(la, lb);
+    }
+  } else {
+    inner* ia = static_cast<inner*>(a);
+    inner* ib = static_cast<inner*>(b);
+    if (ia->children.size() + ib->children.size() <= fanout) {
+      merge(ia, ib);
+      merged = true;
+    } else {
+      balance(ia, ib);
+    }
+  }
+
+  n->counts[left] = a->count;
+  if (merged) {
+    n->children.erase(n->children.begin() + left + 1);
+    n->counts.erase(n->counts.begin() + left + 1);
+  } else {
+    n->counts[left + 1] = b->count;
+  }
+}
+
+template <typename T, size_t ChunkSize>
+bool rope_vector<T, ChunkSize>::underfull(const node* n) noexcept {
+  return n->is_leaf ? static_cast<const leaf*>(n)->items.size() < ChunkSize / 4
+                    : static_cast<const inner*>(n)->children.size() < fanout / 4;
+}
+
+// Moves everything from right into left and deletes right.
+template <typename T, size_t ChunkSize>
+bool rope_vector<T, ChunkSize>::merge(leaf* left, leaf* right) noexcept {
+  size_t old_size = left->items.size();
+  try {
+    for (const T& value : right->items) {
+      left->items.push_back(value);
+    }
+  } catch (...) {
+    while (left->items.size() > old_size) {
+      left->items.pop_back();
+    }
+    return false;
+  }
+  left->count = left->items.size();
+  left->next = right->next;
+  if (right->next != nullptr) {
+    right->next->prev = left;
+  }
+  delete right;
+  return true;
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::merge(inner* left, inner* right) noexcept {
+  // both have room for fanout + 1 entries and together hold at most that many
+  for (size_t i = 0; i < right->children.size(); ++i) {
+    left->children.push_back(right->children[i]);
+    left->counts.push_back(right->counts[i]);
+  }
+  left->count += right->count;
+  delete right;
+}
+
+template <typename T, size_t ChunkSize>
+bool rope_vector<T, ChunkSize>::balance(leaf* left, leaf* right) {
+  size_t target = (left->items.size() + right->items.size()) / 2;
+  if (left->items.size() < target) {
+    // the front of right moves to the back of left, which has room for a whole
+    // chunk, and the rest of right to a new buffer
+    size_t moved = target - left->items.size();
+    size_t old_size = left->items.size();
+    try {
+      vector<T> items;
+      items.reserve(ChunkSize + 1);
+      for (size_t i = moved; i < right->items.size(); ++i) {
+        items.push_back(right->items[i]);
+      }
+      for (size_t i = 0; i < moved; ++i) {
+        left->items.push_back(right->items[i]);
+      }
+      right->items.swap(items);
+    } catch (...) {
+      while (left->items.size() > old_size) {
+        left->items.pop_back();
+      }
+      return false;
+    }
+  } else {
+    // the back of left moves to the front of right, through a new buffer
+    size_t moved = left->items.size() - target;
+    try {
+      vector<T> items;
+      items.reserve(ChunkSize + 1);
+      for (size_t i = target; i < left->items.size(); ++i) {
+        items.push_back(left->items[i]);
+      }
+      for (const T& value : right->items) {
+        items.push_back(value);
+      }
+      right->items.swap(items);
+    } catch (...) {
+      return false;
+    }
+    left->items.erase(left->items.end() - moved, left->items.end());
+  }
+  left->count = left->items.size();
+  right->count = right->items.size();
+  return true;
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::balance(inner* left, inner* right) noexcept {
+  // both have room for fanout + 1 entries and end up with at most fanout
+  size_t target = (left->children.size() + right->children.size()) / 2;
+  size_t moved_count = 0;
+  if (left->children.size() < target) {
+    size_t moved = target - left->children.size();
+    for (size_t i = 0; i < moved; ++i) {
+      left->children.push_back(right->children[i]);
+      left->counts.push_back(right->counts[i]);
+      moved_count += right->counts[i];
+    }
+    right->children.erase(right->children.begin(), right->children.begin() + moved);
+    right->counts.erase(right->counts.begin(), right->counts.begin() + moved);
+    left->count += moved_count;
+    right->count -= moved_count;
+  } else {
+    size_t moved = left->children.size() - target;
+    for (size_t i = 0; i < moved; ++i) {
+      right->children.insert(right->children.begin() + i, left->children[target + i]);
+      right->counts.insert(right->counts.begin() + i, left->counts[target + i]);
+      moved_count += left->counts[target + i];
+    }
+    left->children.erase(left->children.begin() + target, left->children.end());
+    left->counts.erase(left->counts.begin() + target, left->counts.end());
+    left->count -= moved_count;
+    right->count += moved_count;
+  }
+}
+
+template <typename T, size_t ChunkSize>
+void rope_vector<T, ChunkSize>::destroy(node* n) noexcept {
+  if (n->is_leaf) {
+    delete static_cast<leaf*>(n);
+    return;
+  }
+  inner* in = static_cast<inner*>(n);
+  for (node* child : in->children) {
+    destroy(child);
+  }
+  delete in;
+}
+
+template <typename T, size_t ChunkSize>
+size_t rope_vector<T, ChunkSize>::locate(const inner* n, size_t& index) noexcept {
+  size_t last = n->counts.size() - 1;
+  for (size_t i = 0; i < last; ++i) {
+    if (index < n->counts[i]) {
+      return i;
+    }
+    index -= n->counts[i];
+  }
+  return last;
+}
+
+template <typename T, size_t ChunkSize>
+const typename rope_vector<T, ChunkSize>::leaf* rope_vector<T, ChunkSize>::find_leaf(size_t& index) const noexcept {
+  const node* n = _root;
+  while (!n->is_leaf) {
+    const inner* in = static_cast<const inner*>(n);
+    n = in->children[locate(in, index)];
+  }
+  return static_cast<const leaf*>(n);
+}
@@ -0,0 +1,535 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define VECTOR_HAVE_SHARED_MEMORY
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef VECTOR_HAVE_SHARED_MEMORY
+
+// Vector of trivially copyable T in a POSIX shared memory segment, for handing
+// data to other processes on the host without copying it through a pipe. The
+// segment starts with a header holding the size, capacity and a generation
+// counter, followed by the elements.
+//
+// One writer, any number of readers, each with its own mapping. Every change
+// is a write section: the writer makes the generation odd, changes the data,
+// and makes it even again. Readers look at the data in place through
+// try_read(), which reports whether the generation stayed the same and even
+// meanwhile, or take a consistent copy with snapshot(). As with any seqlock,
+// the callback of try_read() may see data that is being overwritten and must
+// only read it.
+//
+// The segment maps max_capacity elements of address space up front and grows
+// the file behind it on demand, so growth never moves the elements and readers
+// never have to remap.
+template <typename T>
+class shm_vector {
+  static_assert(std::is_trivially_copyable_v<T>, "shm_vector holds trivially copyable types only");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "the header is shared between processes");
+
+  struct header {
+    uint64_t magic;
+    uint64_t element_size;
+    uint64_t max_capacity;
+    std::atomic<uint64_t> generation;
+    std::atomic<uint64_t> size;
+    std::atomic<uint64_t> capacity;
+  };
+
+  // "shvecv01" in little-endian byte order
+  static constexpr uint64_t magic = 0x31307663'65766873ull;
+  // the elements start on a cache line of their own
+  static constexpr size_t data_alignment = std::max<size_t>(alignof(T), 64);
+  static constexpr size_t data_offset = (sizeof(header) + data_alignment - 1) / data_alignment * data_alignment;
+
+public:
+  using value_type = T;
+
+  using const_reference = const T&;
+  using const_pointer = const T*;
+
+  // O(1) nothrow, maps nothing
+  shm_vector() noexcept = default;
+
+  shm_vector(const shm_vector&) = delete;
+  shm_vector& operator=(const shm_vector&) = delete;
+
+  // O(1) nothrow
+  shm_vector(shm_vector&& other) noexcept;
+
+  // O(1) nothrow
+  shm_vector& operator=(shm_vector&& other) noexcept;
+
+  // O(1) nothrow, unmaps; the segment lives on while it has a name or a mapping
+  ~shm_vector() noexcept;
+
+  // O(1) strong, writer of a new segment named name (see shm_open) that can
+  // grow to max_capacity elements; throws std::system_error if it exists
+  static shm_vector create(const char* name, size_t max_capacity);
+
+  // O(1) strong, writer of a new unnamed segment; share it through fd()
+  static shm_vector create_anonymous(size_t max_capacity);
+
+  // O(1) strong, reader of the segment named name
+  static shm_vector open(const char* name);
+
+  // O(1) strong, reader of the segment behind fd, which is duplicated
+  static shm_vector open(int fd);
+
+  // O(1) nothrow, removes the name; mappings stay valid
+  static void unlink(const char* name) noexcept;
+
+  // O(1) nothrow, the descriptor of the segment, for passing to other processes
+  int fd() const noexcept;
+
+  // O(1) nothrow
+  bool writable() const noexcept;
+
+  // O(1) nothrow, even when no write section is in progress
+  uint64_t generation() const noexcept;
+
+  // O(1) nothrow, as of the last finished write section
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  size_t capacity() const noexcept;
+
+  // O(1) nothrow
+  size_t max_capacity() const noexcept;
+
+  // O(1) nothrow, for the writer, and for readers inside try_read()
+  const_pointer data() const noexcept;
+
+  // O(1) nothrow, same as above
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(f) calls f with a std::span<const T> over the elements in place;
+  // true if no write section overlapped, so what f saw was consistent
+  template <typename F>
+  bool try_read(F&& f) const;
+
+  // O(N) strong, consistent copy, retried while the writer is active
+  vector<T> snapshot() const;
+
+  // O(1)* strong, writer only
+  void push_back(const T& value);
+
+  // O(1) strong, writer only; does nothing when empty
+  void pop_back();
+
+  // O(1) strong, writer only; std::out_of_range when index >= size()
+  void set(size_t index, const T& value);
+
+  // O(N) strong, writer only; std::length_error past max_capacity()
+  void assign(std::span<const T> values);
+
+  // O(1) strong, writer only
+  void clear();
+
+  // O(1) strong, writer only; grows the segment to hold new_capacity
+  // elements, std::length_error past max_capacity()
+  void reserve(size_t new_capacity);
+
+  // O(f) basic, writer only; one write section in which f gets a std::span<T>
+  // over the elements to change in place
+  template <typename F>
+  void modify(F&& f);
+
+  // O(1) nothrow
+  void swap(shm_vector& other) noexcept;
+
+private:
+  // O(1) strong, maps a segment whose header is already valid
+  static shm_vector map(int fd, bool writer);
+
+  // O(1) strong, sets up a new segment on an empty fd
+  static shm_vector initialize(int fd, size_t max_capacity);
+
+  static size_t segment_bytes(size_t capacity) noexcept;
+
+  void check_writer() const;
+
+  void begin_write() noexcept;
+
+  void end_write() noexcept;
+
+  T* mutable_data() noexcept;
+
+  header* _header = nullptr;
+  size_t _mapped_bytes = 0;
+  int _fd = -1;
+  bool _writer = false;
+};
+
+template <typename T>
+shm_vector<T>::shm_vector(shm_vector&& other) noexcept {
+  swap(other);
+}
+
+template <typename T>
+shm_vector<T>& shm_vector<T>::operator=(shm_vector&& other) noexcept {
+  if (this != &other) {
+    shm_vector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T>
+shm_vector<T>::~shm_vector() noexcept {
+  if (_header != nullptr) {
+    ::munmap(_header, _mapped_bytes);
+  }
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+}
+
+template <typename T>
+shm_vector<T> shm_vector<T>::create(const char* name, size_t max_capacity) {
+  int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "shm_open");
+  }
+  try {
+    return initialize(fd, max_capacity);
+  } catch (...) {
+    ::shm_unlink(name);
+    throw;
+  }
+}
+
+template <typename T>
+shm_vector<T> shm_vector<T>::create_anonymous(size_t max_capacity) {
+#ifdef __linux__
+  int fd = ::memfd_create("shm_vector", MFD_CLOEXEC);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "memfd_create");
+  }
+  return initialize(fd, max_capacity);
+#else
+  // a private name, removed at once
+  std::string name = "/shm_vector." + std::to_string(::getpid()) + "." + std::to_string(reinterpret_cast<uintptr_t>(&name));
+  shm_vector result = create(name.c_str(), max_capacity);
+  unlink(name.c_str());
+  return result;
+#endif
+}
+
+template <typename T>
+shm_vector<T> shm_vector<T>::open(const char* name) {
+  int fd = ::shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "shm_open");
+  }
+  return map(fd, false);
+}
+
+template <typename T>
+shm_vector<T> shm_vector<T>::open(int fd) {
+  int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (own < 0) {
+    throw std::system_error(errno, std::generic_category(), "fcntl");
+  }
+  return map(own, false);
+}
+
+template <typename T>
+void shm_vector<T>::unlink(const char* name) noexcept {
+  ::shm_unlink(name);
+}
+
+template <typename T>
+int shm_vector<T>::fd() const noexcept {
+  return _fd;
+}
+
+template <typename T>
+bool shm_vector<T>::writable() const noexcept {
+  return _writer;
+}
+
+template <typename T>
+uint64_t shm_vector<T>::generation() const noexcept {
+  return _header->generation.load(std::memory_order_acquire);
+}
+
+template <typename T>
+size_t shm_vector<T>::size() const noexcept {
+  return static_cast<size_t>(_header->size.load(std::memory_order_acquire));
+}
+
+template <typename T>
+bool shm_vector<T>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename T>
+size_t shm_vector<T>::capacity() const noexcept {
+  return static_cast<size_t>(_header->capacity.load(std::memory_order_acquire));
+}
+
+template <typename T>
+size_t shm_vector<T>::max_capacity() const noexcept {
+  return static_cast<size_t>(_header->max_capacity);
+}
+
+template <typename T>
+const T* shm_vector<T>::data() const noexcept {
+  return reinterpret_cast<const T*>(reinterpret_cast<const unsigned char*>(_header) + data_offset);
+}
+
+template <typename T>
+const T& shm_vector<T>::operator[](size_t index) const noexcept {
+  return data()[index];
+}
+
+template <typename T>
+template <typename F>
+bool shm_vector<T>::try_read(F&& f) const {
+  uint64_t before = _header->generation.load(std::memory_order_acquire);
+  if (before % 2 != 0) {
+    return false;
+  }
+  // the size may belong to a newer generation, but never exceeds the capacity backing it
+  size_t count = std::min(size(), capacity());
+  f(std::span<const T>(data(), count));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return _header->generation.load(std::memory_order_relaxed) == before;
+}
+
+template <typename T>
+vector<T> shm_vector<T>::snapshot() const {
+  vector<T> result;
+  while (true) {
+    // room first, outside the read, so the copy itself cannot throw
+    result.reserve(size());
+    bool fits = true;
+    bool consistent = try_read([&](std::span<const T> values) {
+      fits = values.size() <= result.capacity();
+      if (fits) {
+        if constexpr (std::is_default_constructible_v<T>) {
+          result.resize(values.size());
+          if (!values.empty()) {
+            std::memcpy(static_cast<void*>(result.data()), values.data(), values.size_bytes());
+          }
+        } else {
+          result.clear();
+          for (const T& value : values) {
+            result.push_back(value);
+          }
+        }
+      }
+    });
+    if (consistent && fits) {
+      return result;
+    }
+  }
+}
+
+template <typename T>
+void shm_vector<T>::push_back(const T& value) {
+  check_writer();
+  size_t count = size();
+  if (count == capacity()) {
+    reserve(std::min(std::max<size_t>(2 * count, 64), max_capacity()));
+    if (count == capacity()) {
+      throw std::length_error("shm_vector: max_capacity exceeded");
+    }
+  }
+  begin_write();
+  std::memcpy(static_cast<void*>(mutable_data() + count), &value, sizeof(T));
+  _header->size.store(count + 1, std::memory_order_release);
+  end_write();
+}
+
+template <typename T>
+void shm_vector<T>::pop_back() {
+  check_writer();
+  size_t count = size();
+  if (count == 0) {
+    return;
+  }
+  begin_write();
+  _header->size.store(count - 1, std::memory_order_release);
+  end_write();
+}
+
+template <typename T>
+void shm_vector<T>::set(size_t index, const T& value) {
+  check_writer();
+  // past size() may be past the end of the segment, which raises SIGBUS
+  if (index >= size()) {
+    throw std::out_of_range("shm_vector: index out of range");
+  }
+  begin_write();
+  std::memcpy(static_cast<void*>(mutable_data() + index), &value, sizeof(T));
+  end_write();
+}
+
+template <typename T>
+void shm_vector<T>::assign(std::span<const T> values) {
+  check_writer();
+  reserve(values.size());
+  begin_write();
+  if (!values.empty()) {
+    std::memcpy(static_cast<void*>(mutable_data()), values.data(), values.size_bytes());
+  }
+  _header->size.store(values.size(), std::memory_order_release);
+  end_write();
+}
+
+template <typename T>
+void shm_vector<T>::clear() {
+  check_writer();
+  begin_write();
+  _header->size.store(0, std::memory_order_release);
+  end_write();
+}
+
+template <typename T>
+void shm_vector<T>::reserve(size_t new_capacity) {
+  check_writer();
+  if (new_capacity <= capacity()) {
+    return;
+  }
+  if (new_capacity > max_capacity()) {
+    throw std::length_error("shm_vector: max_capacity exceeded");
+  }
+  if (::ftruncate(_fd, static_cast<off_t>(segment_bytes(new_capacity))) != 0) {
+    throw std::system_error(errno, std::generic_category(), "ftruncate");
+  }
+  // readers clamp to the capacity, so it is published only once the file backs it
+  _header->capacity.store(new_capacity, std::memory_order_release);
+}
+
+template <typename T>
+template <typename F>
+void shm_vector<T>::modify(F&& f) {
+  check_writer();
+  begin_write();
+  try {
+    f(std::span<T>(mutable_data(), size()));
+  } catch (...) {
+    end_write();
+    throw;
+  }
+  end_write();
+}
+
+template <typename T>
+void shm_vector<T>::swap(shm_vector& other) noexcept {
+  std::swap(_header, other._header);
+  std::swap(_mapped_bytes, other._mapped_bytes);
+  std::swap(_fd, other._fd);
+  std::swap(_writer, other._writer);
+}
+
+template <typename T>
+shm_vector<T> shm_vector<T>::map(int fd, bool writer) {
+  shm_vector result;
+  result._fd = fd;
+  result._writer = writer;
+
+  header h;
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    throw std::system_error(errno, std::generic_category(), "fstat");
+  }
+  if (static_cast<size_t>(st.st_size) < sizeof(header) || ::pread(fd, &h, sizeof(header), 0) != sizeof(header)) {
+    throw std::runtime_error("shm_vector: segment too small");
+  }
+  if (h.magic != magic || h.element_size != sizeof(T)) {
+    throw std::runtime_error("shm_vector: segment holds a different type");
+  }
+
+  size_t bytes = segment_bytes(static_cast<size_t>(h.max_capacity));
+  int protection = writer ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* address = ::mmap(nullptr, bytes, protection, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+  result._header = static_cast<header*>(address);
+  result._mapped_bytes = bytes;
+  return result;
+}
+
+template <typename T>
+shm_vector<T> shm_vector<T>::initialize(int fd, size_t max_capacity) {
+  if (max_capacity > (SIZE_MAX - data_offset) / sizeof(T)) {
+    ::close(fd);
+    throw std::length_error("shm_vector: max_capacity too large");
+  }
+  if (::ftruncate(fd, static_cast<off_t>(segment_bytes(0))) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "ftruncate");
+  }
+
+  header h;
+  h.magic = magic;
+  h.element_size = sizeof(T);
+  h.max_capacity = max_capacity;
+  h.generation.store(0, std::memory_order_relaxed);
+  h.size.store(0, std::memory_order_relaxed);
+  h.capacity.store(0, std::memory_order_relaxed);
+  if (::pwrite(fd, &h, sizeof(header), 0) != sizeof(header)) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "pwrite");
+  }
+  return map(fd, true);
+}
+
+template <typename T>
+size_t shm_vector<T>::segment_bytes(size_t capacity) noexcept {
+  return data_offset + capacity * sizeof(T);
+}
+
+template <typename T>
+void shm_vector<T>::check_writer() const {
+  if (!_writer) {
+    throw std::logic_error("shm_vector: only the writer may modify the segment");
+  }
+}
+
+template <typename T>
+void shm_vector<T>::begin_write() noexcept {
+  _header->generation.fetch_add(1, std::memory_order_relaxed);
+  // the odd generation becomes visible before any of the changes
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename T>
+void shm_vector<T>::end_write() noexcept {
+  _header->generation.fetch_add(1, std::memory_order_release);
+}
+
+template <typename T>
+T* shm_vector<T>::mutable_data() noexcept {
+  return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(_header) + data_offset);
+}
+
+#endif
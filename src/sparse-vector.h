@@ -0,0 +1,458 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Vector of size() slots in which only the slots differing from a default value
+// are stored, as (index, value) pairs in two sorted arrays. Scans over
+// indices() and values() and most of the memory scale with nnz() instead of
+// size().
+//
+// Every block of block_bits slots that ever held an entry gets an occupancy
+// bitmap and the number of entries before it, so contains() and operator[]
+// are O(1): a few popcounts within the block give the position in the arrays.
+// Empty blocks cost one uint32_t each.
+template <typename T, typename Policy = vector_policy>
+class sparse_vector {
+public:
+  using value_type = T;
+
+  using const_reference = const T&;
+
+  static constexpr size_t block_bits = 512;
+
+  // O(1)
+  sparse_vector() = default;
+
+  // O(N / block_bits) strong, size slots holding default_value
+  explicit sparse_vector(size_t size, const T& default_value = T());
+
+  // O(N) strong, stores the elements of dense that differ from default_value
+  template <typename P>
+  explicit sparse_vector(const vector<T, P>& dense, const T& default_value = T());
+
+  // O(nnz + N / block_bits) strong
+  sparse_vector(const sparse_vector& other) = default;
+
+  // O(1) nothrow if moving T does not throw, other is left empty
+  sparse_vector(sparse_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+  // O(nnz + N / block_bits) strong
+  sparse_vector& operator=(const sparse_vector& other);
+
+  // O(1) nothrow if moving T does not throw, other is left empty
+  sparse_vector& operator=(sparse_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                                          std::is_nothrow_swappable_v<T>);
+
+  // O(1) nothrow, the stored value or the default
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow, whether index holds a stored value
+  bool contains(size_t index) const noexcept;
+
+  // O(nnz) strong, O(1)* when index is past every stored entry; a value equal
+  // to the default drops the entry instead
+  void set(size_t index, const T& value);
+
+  // O(nnz) basic, nothrow if assigning T does not throw; drops the entry at index
+  void reset(size_t index);
+
+  // O(1)* strong
+  void push_back(const T& value);
+
+  // O(1) nothrow, does nothing when empty
+  void pop_back() noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow, number of stored entries
+  size_t nnz() const noexcept;
+
+  // O(1) nothrow
+  const_reference default_value() const noexcept;
+
+  // O(N / block_bits) strong when growing, nothrow when shrinking
+  void resize(size_t new_size);
+
+  // O(nnz) nothrow, size() becomes 0
+  void clear() noexcept;
+
+  // O(1) nothrow, ascending indices of the stored entries
+  vector_view<const size_t> indices() const noexcept;
+
+  // O(1) nothrow, values of the stored entries, in the order of indices()
+  vector_view<const T> values() const noexcept;
+
+  // O(N) strong
+  vector<T, Policy> to_dense() const;
+
+  // O(1) nothrow, bytes held by the buffers
+  size_t memory_usage() const noexcept;
+
+  // O(1) nothrow
+  void swap(sparse_vector& other) noexcept;
+
+private:
+  static constexpr size_t word_bits = 64;
+
+  struct block {
+    uint64_t words[block_bits / word_bits];
+    // entries in earlier blocks
+    size_t rank;
+    // slot / block_bits of the first slot
+    size_t index;
+  };
+
+  // position of index in the entry arrays, counting only entries before it
+  size_t position(const block& b, size_t index) const noexcept;
+
+  // O(blocks) strong, the block of index, created if missing
+  block& block_for(size_t index);
+
+  // number of blocks covering size slots
+  static size_t blocks_for(size_t size) noexcept;
+
+  // O(nnz) strong, inserts value into _values at pos
+  void insert_value(size_t pos, const T& value);
+
+  size_t _size = 0;
+  T _default = T();
+  vector<size_t, Policy> _indices;
+  vector<T, Policy> _values;
+  // ordered by index
+  vector<block, Policy> _blocks;
+  // for every block of slots: 1 + its position in _blocks, 0 without a bitmap
+  vector<uint32_t, Policy> _block_of;
+};
+
+template <typename T, typename Policy>
+sparse_vector<T, Policy>::sparse_vector(size_t size, const T& default_value)
+    : _default(default_value) {
+  resize(size);
+}
+
+template <typename T, typename Policy>
+template <typename P>
+sparse_vector<T, Policy>::sparse_vector(const vector<T, P>& dense, const T& default_value)
+    : _default(default_value) {
+  for (const T& value : dense) {
+    push_back(value);
+  }
+}
+
+template <typename T, typename Policy>
+sparse_vector<T, Policy>::sparse_vector(sparse_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : _size(std::exchange(other._size, 0))
+    , _default(std::move(other._default))
+    , _indices(std::move(other._indices))
+    , _values(std::move(other._values))
+    , _blocks(std::move(other._blocks))
+    , _block_of(std::move(other._block_of)) {}
+
+template <typename T, typename Policy>
+sparse_vector<T, Policy>& sparse_vector<T, Policy>::operator=(const sparse_vector& other) {
+  if (this != &other) {
+    sparse_vector copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+sparse_vector<T, Policy>& sparse_vector<T, Policy>::operator=(sparse_vector&& other) noexcept(
+    std::is_nothrow_move_constructible_v<T> && std::is_nothrow_swappable_v<T>) {
+  if (this != &other) {
+    sparse_vector moved(std::move(other));
+    swap(moved);
+  }
+  return *this;
+}
+
+template <typename T, typename Policy>
+const T& sparse_vector<T, Policy>::operator[](size_t index) const noexcept {
+  uint32_t slot = _block_of[index / block_bits];
+  if (slot == 0) {
+    return _default;
+  }
+  const block& b = _blocks[slot - 1];
+  size_t bit = index % block_bits;
+  if ((b.words[bit / word_bits] >> bit % word_bits & 1) == 0) {
+    return _default;
+  }
+  return _values[position(b, index)];
+}
+
+template <typename T, typename Policy>
+bool sparse_vector<T, Policy>::contains(size_t index) const noexcept {
+  uint32_t slot = _block_of[index / block_bits];
+  size_t bit = index % block_bits;
+  return slot != 0 && (_blocks[slot - 1].words[bit / word_bits] >> bit % word_bits & 1) != 0;
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::set(size_t index, const T& value) {
+  if (value == _default) {
+    reset(index);
+    return;
+  }
+  if (contains(index)) {
+    _values[position(_blocks[_block_of[index / block_bits] - 1], index)] = value;
+    return;
+  }
+
+  // an empty block left behind by a throwing insert is harmless
+  block& b = block_for(index);
+  size_t pos = position(b, index);
+  if (pos == _indices.size()) {
+    _indices.push_back(index);
+    try {
+      _values.push_back(value);
+    } catch (...) {
+      _indices.pop_back();
+      throw;
+    }
+  } else {
+    _indices.insert(_indices.begin() + pos, index);
+    try {
+      insert_value(pos, value);
+    } catch (...) {
+      _indices.erase(_indices.begin() + pos);
+      throw;
+    }
+  }
+
+  size_t bit = index % block_bits;
+  b.words[bit / word_bits] |= uint64_t(1) << bit % word_bits;
+  for (size_t i = _block_of[index / block_bits]; i < _blocks.size(); ++i) {
+    ++_blocks[i].rank;
+  }
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::reset(size_t index) {
+  if (!contains(index)) {
+    return;
+  }
+  uint32_t slot = _block_of[index / block_bits];
+  block& b = _blocks[slot - 1];
+  size_t pos = position(b, index);
+  // the value goes first: erasing a size_t cannot throw, so a throwing shift
+  // of the values leaves the index and the bitmap untouched and both arrays
+  // the same length
+  _values.erase(_values.begin() + pos);
+  _indices.erase(_indices.begin() + pos);
+
+  size_t bit = index % block_bits;
+  b.words[bit / word_bits] &= ~(uint64_t(1) << bit % word_bits);
+  for (size_t i = slot; i < _blocks.size(); ++i) {
+    --_blocks[i].rank;
+  }
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::push_back(const T& value) {
+  bool new_block = _size % block_bits == 0;
+  if (new_block) {
+    _block_of.push_back(0);
+  }
+  try {
+    if (!(value == _default)) {
+      set(_size, value);
+    }
+  } catch (...) {
+    if (new_block) {
+      if (_block_of.back() != 0) {
+        _blocks.pop_back();
+      }
+      _block_of.pop_back();
+    }
+    throw;
+  }
+  ++_size;
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::pop_back() noexcept {
+  if (_size > 0) {
+    resize(_size - 1);
+  }
+}
+
+template <typename T, typename Policy>
+size_t sparse_vector<T, Policy>::size() const noexcept {
+  return _size;
+}
+
+template <typename T, typename Policy>
+bool sparse_vector<T, Policy>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T, typename Policy>
+size_t sparse_vector<T, Policy>::nnz() const noexcept {
+  return _indices.size();
+}
+
+template <typename T, typename Policy>
+const T& sparse_vector<T, Policy>::default_value() const noexcept {
+  return _default;
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::resize(size_t new_size) {
+  size_t old_blocks = _block_of.size();
+  size_t new_blocks = blocks_for(new_size);
+  if (new_size >= _size) {
+    try {
+      while (_block_of.size() < new_blocks) {
+        _block_of.push_back(0);
+      }
+    } catch (...) {
+      while (_block_of.size() > old_blocks) {
+        _block_of.pop_back();
+      }
+      throw;
+    }
+    _size = new_size;
+    return;
+  }
+
+  // the dropped entries form the tail of the arrays
+  size_t keep = std::lower_bound(_indices.begin(), _indices.end(), new_size) - _indices.begin();
+  for (size_t i = keep; i < _indices.size(); ++i) {
+    size_t index = _indices[i];
+    size_t bit = index % block_bits;
+    _blocks[_block_of[index / block_bits] - 1].words[bit / word_bits] &= ~(uint64_t(1) << bit % word_bits);
+  }
+  if (keep < _indices.size()) {
+    _values.erase(_values.begin() + keep, _values.end());
+    _indices.erase(_indices.begin() + keep, _indices.end());
+  }
+  while (!_blocks.empty() && _blocks.back().index >= new_blocks) {
+    _blocks.pop_back();
+  }
+  while (_block_of.size() > new_blocks) {
+    _block_of.pop_back();
+  }
+  _size = new_size;
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::clear() noexcept {
+  _indices.clear();
+  _values.clear();
+  _blocks.clear();
+  _block_of.clear();
+  _size = 0;
+}
+
+template <typename T, typename Policy>
+vector_view<const size_t> sparse_vector<T, Policy>::indices() const noexcept {
+  return _indices.view();
+}
+
+template <typename T, typename Policy>
+vector_view<const T> sparse_vector<T, Policy>::values() const noexcept {
+  return _values.view();
+}
+
+template <typename T, typename Policy>
+vector<T, Policy> sparse_vector<T, Policy>::to_dense() const {
+  vector<T, Policy> dense;
+  dense.reserve(_size);
+  size_t next = 0;
+  for (size_t i = 0; i < _size; ++i) {
+    if (next < _indices.size() && _indices[next] == i) {
+      dense.push_back(_values[next++]);
+    } else {
+      dense.push_back(_default);
+    }
+  }
+  return dense;
+}
+
+template <typename T, typename Policy>
+size_t sparse_vector<T, Policy>::memory_usage() const noexcept {
+  return _indices.capacity() * sizeof(size_t) + _values.capacity() * sizeof(T) + _blocks.capacity() * sizeof(block) +
+         _block_of.capacity() * sizeof(uint32_t);
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::swap(sparse_vector& other) noexcept {
+  using std::swap;
+  swap(_size, other._size);
+  swap(_default, other._default);
+  _indices.swap(other._indices);
+  _values.swap(other._values);
+  _blocks.swap(other._blocks);
+  _block_of.swap(other._block_of);
+}
+
+template <typename T, typename Policy>
+size_t sparse_vector<T, Policy>::position(const block& b, size_t index) const noexcept {
+  size_t bit = index % block_bits;
+  size_t pos = b.rank;
+  for (size_t i = 0; i < bit / word_bits; ++i) {
+    pos += std::popcount(b.words[i]);
+  }
+  return pos + std::popcount(b.words[bit / word_bits] & ((uint64_t(1) << bit % word_bits) - 1));
+}
+
+template <typename T, typename Policy>
+typename sparse_vector<T, Policy>::block& sparse_vector<T, Policy>::block_for(size_t index) {
+  size_t b = index / block_bits;
+  if (_block_of[b] != 0) {
+    return _blocks[_block_of[b] - 1];
+  }
+
+  size_t at = std::lower_bound(_blocks.begin(), _blocks.end(), b, [](const block& x, size_t i) { return x.index < i; }) -
+              _blocks.begin();
+  block created{};
+  created.rank = at < _blocks.size() ? _blocks[at].rank : _indices.size();
+  created.index = b;
+  if (at == _blocks.size()) {
+    _blocks.push_back(created);
+  } else {
+    _blocks.insert(_blocks.begin() + at, created);
+    for (size_t i = at + 1; i < _blocks.size(); ++i) {
+      ++_block_of[_blocks[i].index];
+    }
+  }
+  _block_of[b] = static_cast<uint32_t>(at + 1);
+  return _blocks[at];
+}
+
+template <typename T, typename Policy>
+size_t sparse_vector<T, Policy>::blocks_for(size_t size) noexcept {
+  return (size + block_bits - 1) / block_bits;
+}
+
+template <typename T, typename Policy>
+void sparse_vector<T, Policy>::insert_value(size_t pos, const T& value) {
+  if constexpr (trivially_relocatable<T>) {
+    _values.insert(_values.begin() + pos, value);
+  } else {
+    // vector::insert shifts by copies that cannot be undone, so the entries go
+    // to a new buffer
+    vector<T, Policy> values;
+    values.reserve(_values.size() + 1);
+    for (size_t i = 0; i < pos; ++i) {
+      values.push_back(_values[i]);
+    }
+    values.push_back(value);
+    for (size_t i = pos; i < _values.size(); ++i) {
+      values.push_back(_values[i]);
+    }
+    _values.swap(values);
+  }
+}
@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// What static_vector does when an insertion would exceed its capacity.
+enum class static_vector_overflow {
+  // throw std::length_error and leave the vector unchanged
+  throws,
+  // a precondition of the caller, checked with assert()
+  precondition,
+};
+
+// vector with the storage of N elements inside the object and no heap use.
+// Trivially copyable when T is, so it can be copied with a single memcpy, and
+// usable in constant expressions for trivial T.
+template <typename T, size_t N, static_vector_overflow Overflow = static_vector_overflow::throws>
+class static_vector {
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using pointer = T*;
+  using const_pointer = const T*;
+
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  // O(1) nothrow
+  constexpr static_vector() noexcept {}
+
+  // O(N) strong
+  constexpr static_vector(const static_vector& other)
+    requires std::is_trivially_copy_constructible_v<T>
+  = default;
+
+  // O(N) strong
+  constexpr static_vector(const static_vector& other);
+
+  // O(N) strong if moving T does not throw
+  constexpr static_vector(static_vector&& other)
+    requires std::is_trivially_move_constructible_v<T>
+  = default;
+
+  // O(N) strong if moving T does not throw
+  constexpr static_vector(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+  // O(N) strong
+  constexpr static_vector& operator=(const static_vector& other)
+    requires std::is_trivially_copy_assignable_v<T> && std::is_trivially_copy_constructible_v<T> &&
+             std::is_trivially_destructible_v<T>
+  = default;
+
+  // O(N) strong if moving T does not throw
+  constexpr static_vector& operator=(const static_vector& other);
+
+  // O(N) basic
+  constexpr static_vector& operator=(static_vector&& other)
+    requires std::is_trivially_move_assignable_v<T> && std::is_trivially_move_constructible_v<T> &&
+             std::is_trivially_destructible_v<T>
+  = default;
+
+  // O(N) basic
+  constexpr static_vector& operator=(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+  // O(N) nothrow
+  constexpr ~static_vector()
+    requires std::is_trivially_destructible_v<T>
+  = default;
+
+  // O(N) nothrow
+  constexpr ~static_vector();
+
+  // O(1) nothrow
+  constexpr reference operator[](size_t index) noexcept;
+
+  // O(1) nothrow
+  constexpr const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  constexpr pointer data() noexcept;
+
+  // O(1) nothrow
+  constexpr const_pointer data() const noexcept;
+
+  // O(1) nothrow
+  constexpr size_t size() const noexcept;
+
+  // O(1) nothrow
+  constexpr reference front() noexcept;
+
+  // O(1) nothrow
+  constexpr const_reference front() const noexcept;
+
+  // O(1) nothrow
+  constexpr reference back() noexcept;
+
+  // O(1) nothrow
+  constexpr const_reference back() const noexcept;
+
+  // O(1) strong
+  constexpr void push_back(const T& value);
+
+  // O(1) nothrow, the vector must not be empty (checked with assert())
+  constexpr void pop_back() noexcept;
+
+  // O(1) nothrow
+  constexpr bool empty() const noexcept;
+
+  // O(1) nothrow
+  static constexpr size_t capacity() noexcept;
+
+  // O(1) nothrow
+  static constexpr size_t max_size() noexcept;
+
+  // O(1) strong, only checks new_capacity against N
+  constexpr void reserve(size_t new_capacity);
+
+  // O(1) nothrow, the storage is fixed
+  constexpr void shrink_to_fit() noexcept;
+
+  // O(N) nothrow
+  constexpr void clear() noexcept;
+
+  // O(N) nothrow if swapping and moving T does not throw
+  constexpr void swap(static_vector& other) noexcept(std::is_nothrow_swappable_v<T>);
+
+  // O(1) nothrow
+  constexpr iterator begin() noexcept;
+
+  // O(1) nothrow
+  constexpr iterator end() noexcept;
+
+  // O(1) nothrow
+  constexpr const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  constexpr const_iterator end() const noexcept;
+
+  // O(N) strong if moving T does not throw, basic otherwise
+  constexpr iterator insert(const_iterator pos, const T& value);
+
+  // O(N) basic, nothrow if move assigning T does not throw
+  constexpr iterator erase(const_iterator pos);
+
+  // O(N) basic, nothrow if move assigning T does not throw
+  constexpr iterator erase(const_iterator first, const_iterator last);
+
+private:
+  // throws or asserts as selected by Overflow
+  constexpr void check_capacity(size_t required) const;
+
+  // constructs a copy of value in the free slot at index
+  template <typename U>
+  constexpr void construct(size_t index, U&& value);
+
+  size_t _size = 0;
+  union {
+    T _items[N];
+  };
+};
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr static_vector<T, N, Overflow>::static_vector(const static_vector& other) {
+  for (; _size < other._size; ++_size) {
+    construct(_size, other._items[_size]);
+  }
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr static_vector<T, N, Overflow>::static_vector(static_vector&& other) noexcept(
+    std::is_nothrow_move_constructible_v<T>) {
+  for (; _size < other._size; ++_size) {
+    construct(_size, std::move(other._items[_size]));
+  }
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr static_vector<T, N, Overflow>& static_vector<T, N, Overflow>::operator=(const static_vector& other) {
+  if (this != &other) {
+    static_vector copy(other);
+    clear();
+    for (; _size < copy._size; ++_size) {
+      construct(_size, std::move(copy._items[_size]));
+    }
+  }
+  return *this;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr static_vector<T, N, Overflow>& static_vector<T, N, Overflow>::operator=(static_vector&& other) noexcept(
+    std::is_nothrow_move_constructible_v<T>) {
+  if (this != &other) {
+    clear();
+    for (; _size < other._size; ++_size) {
+      construct(_size, std::move(other._items[_size]));
+    }
+  }
+  return *this;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr static_vector<T, N, Overflow>::~static_vector() {
+  clear();
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T& static_vector<T, N, Overflow>::operator[](size_t index) noexcept {
+  return _items[index];
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr const T& static_vector<T, N, Overflow>::operator[](size_t index) const noexcept {
+  return _items[index];
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T* static_vector<T, N, Overflow>::data() noexcept {
+  return _items;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr const T* static_vector<T, N, Overflow>::data() const noexcept {
+  return _items;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr size_t static_vector<T, N, Overflow>::size() const noexcept {
+  return _size;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T& static_vector<T, N, Overflow>::front() noexcept {
+  return _items[0];
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr const T& static_vector<T, N, Overflow>::front() const noexcept {
+  return _items[0];
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T& static_vector<T, N, Overflow>::back() noexcept {
+  return *(_items + _size - 1);
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr const T& static_vector<T, N, Overflow>::back() const noexcept {
+  return *(_items + _size - 1);
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::push_back(const T& value) {
+  check_capacity(_size + 1);
+  construct(_size, value);
+  ++_size;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::pop_back() noexcept {
+  assert(_size > 0);
+  --_size;
+  std::destroy_at(_items + _size);
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr bool static_vector<T, N, Overflow>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr size_t static_vector<T, N, Overflow>::capacity() noexcept {
+  return N;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr size_t static_vector<T, N, Overflow>::max_size() noexcept {
+  return N;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::reserve(size_t new_capacity) {
+  check_capacity(new_capacity);
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::shrink_to_fit() noexcept {}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::clear() noexcept {
+  while (_size > 0) {
+    pop_back();
+  }
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::swap(static_vector& other) noexcept(std::is_nothrow_swappable_v<T>) {
+  static_vector& shorter = _size < other._size ? *this : other;
+  static_vector& longer = _size < other._size ? other : *this;
+  size_t common = shorter._size;
+  std::swap_ranges(shorter._items, shorter._items + common, longer._items);
+  for (; shorter._size < longer._size; ++shorter._size) {
+    shorter.construct(shorter._size, std::move(longer._items[shorter._size]));
+  }
+  while (longer._size > common) {
+    longer.pop_back();
+  }
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T* static_vector<T, N, Overflow>::begin() noexcept {
+  return _items;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T* static_vector<T, N, Overflow>::end() noexcept {
+  return _items + _size;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr const T* static_vector<T, N, Overflow>::begin() const noexcept {
+  return _items;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr const T* static_vector<T, N, Overflow>::end() const noexcept {
+  return _items + _size;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T* static_vector<T, N, Overflow>::insert(const T* pos, const T& value) {
+  size_t index = pos - _items;
+  check_capacity(_size + 1);
+  if (index == _size) {
+    push_back(value);
+    return _items + index;
+  }
+
+  // value may be one of our elements, which the shift below moves
+  T copy(value);
+  construct(_size, std::move(_items[_size - 1]));
+  ++_size;
+  std::move_backward(_items + index, _items + _size - 2, _items + _size - 1);
+  _items[index] = std::move(copy);
+  return _items + index;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T* static_vector<T, N, Overflow>::erase(const T* pos) {
+  return erase(pos, pos + 1);
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr T* static_vector<T, N, Overflow>::erase(const T* first, const T* last) {
+  size_t index = first - _items;
+  size_t count = last - first;
+  std::move(_items + index + count, _items + _size, _items + index);
+  for (size_t i = 0; i < count; ++i) {
+    pop_back();
+  }
+  return _items + index;
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+constexpr void static_vector<T, N, Overflow>::check_capacity(size_t required) const {
+  if constexpr (Overflow == static_vector_overflow::throws) {
+    if (required > N) {
+      throw std::length_error("static_vector: capacity exceeded");
+    }
+  } else {
+    assert(required <= N);
+  }
+}
+
+template <typename T, size_t N, static_vector_overflow Overflow>
+template <typename U>
+constexpr void static_vector<T, N, Overflow>::construct(size_t index, U&& value) {
+  if constexpr (std::is_trivial_v<T>) {
+    // plain assignment starts the lifetime of the array in constant evaluation
+    _items[index] = std::forward<U>(value);
+  } else {
+    std::construct_at(_items + index, std::forward<U>(value));
+  }
+}
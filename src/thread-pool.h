@@ -0,0 +1,288 @@
+#pragma once
+
+#include "ring-vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+// Work-stealing thread pool. Every worker owns a queue: it pushes and pops
+// tasks at the back and, once empty, steals from the front of the others.
+// Tasks submitted from outside the pool go to one shared queue.
+//
+// Threads waiting on a task_group run queued tasks instead of blocking, so
+// parallel code may itself start parallel work on the same pool; once there is
+// nothing left to run, they sleep until a task finishes or is queued.
+class thread_pool {
+public:
+  using task = std::function<void()>;
+
+  // O(workers) strong, with 0 workers all tasks run on threads calling wait()
+  explicit thread_pool(size_t workers);
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  // O(workers) nothrow, all task groups must have finished
+  ~thread_pool() noexcept;
+
+  // O(1) nothrow, workers plus the thread waiting for the result
+  size_t concurrency() const noexcept;
+
+  // O(1), pool with one worker less than there are hardware threads
+  static thread_pool& global();
+
+private:
+  friend class task_group;
+
+  struct queue {
+    std::mutex mutex;
+    ring_vector<task> tasks;
+  };
+
+  // O(1)* strong
+  void push(task t);
+
+  // O(workers), runs one queued task if there is any
+  bool run_one();
+
+  void worker_loop(size_t index) noexcept;
+
+  // O(workers) nothrow, wakes and joins the started workers
+  void stop() noexcept;
+
+  // index of the calling thread's queue
+  size_t own_queue() const noexcept;
+
+  size_t _workers;
+  std::unique_ptr<queue[]> _queues;
+  std::unique_ptr<std::thread[]> _threads;
+
+  std::atomic<size_t> _queued{0};
+  // bumped on every push and on stop; idle workers wait for it to change
+  std::atomic<uint32_t> _signal{0};
+  // bumped on every push and whenever a task of a group finishes; threads
+  // waiting on a task_group wait for it to change. It lives in the pool, as
+  // the group may be gone as soon as its last task is counted as finished.
+  std::atomic<uint32_t> _progress{0};
+  std::atomic<bool> _stop{false};
+
+  inline static thread_local const thread_pool* _current_pool = nullptr;
+  inline static thread_local size_t _current_index = 0;
+};
+
+// Set of tasks on a pool that is waited for as a whole. Tasks may add more
+// tasks to the group they run in. The first exception thrown by a task is
+// rethrown by wait(); tasks not yet started at that point are skipped.
+class task_group {
+public:
+  // O(1) nothrow
+  explicit task_group(thread_pool& pool = thread_pool::global()) noexcept;
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  // waits for outstanding tasks, dropping their exceptions
+  ~task_group() noexcept;
+
+  // O(1)* strong
+  template <typename F>
+  void run(F&& f);
+
+  // runs queued tasks until every task of the group has finished
+  void wait();
+
+private:
+  // runs queued tasks, or sleeps, until every task of the group has finished
+  void drain() noexcept;
+
+  void finish(std::exception_ptr error) noexcept;
+
+  thread_pool& _pool;
+  std::atomic<size_t> _pending{0};
+  std::atomic<bool> _failed{false};
+  std::mutex _error_mutex;
+  std::exception_ptr _error;
+};
+
+inline thread_pool::thread_pool(size_t workers)
+    : _workers(workers)
+    , _queues(new queue[workers + 1])
+    , _threads(new std::thread[workers]) {
+  for (size_t i = 0; i < workers; ++i) {
+    try {
+      _threads[i] = std::thread(&thread_pool::worker_loop, this, i);
+    } catch (...) {
+      _workers = i;
+      stop();
+      throw;
+    }
+  }
+}
+
+inline thread_pool::~thread_pool() noexcept {
+  stop();
+}
+
+inline void thread_pool::stop() noexcept {
+  _stop.store(true);
+  _signal.fetch_add(1);
+  _signal.notify_all();
+  for (size_t i = 0; i < _workers; ++i) {
+    _threads[i].join();
+  }
+}
+
+inline size_t thread_pool::concurrency() const noexcept {
+  return _workers + 1;
+}
+
+inline thread_pool& thread_pool::global() {
+  static thread_pool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return pool;
+}
+
+inline void thread_pool::push(task t) {
+  // counted before the push so it cannot underflow when the task is stolen
+  // right away
+  _queued.fetch_add(1);
+  queue& q = _queues[own_queue()];
+  try {
+    std::lock_guard lock(q.mutex);
+    q.tasks.push_back(std::move(t));
+  } catch (...) {
+    _queued.fetch_sub(1);
+    throw;
+  }
+  _signal.fetch_add(1);
+  _signal.notify_one();
+  _progress.fetch_add(1);
+  _progress.notify_all();
+}
+
+inline bool thread_pool::run_one() {
+  if (_queued.load() == 0) {
+    return false;
+  }
+
+  size_t own = own_queue();
+  task t;
+  for (size_t i = 0; i <= _workers && !t; ++i) {
+    size_t index = (own + i) % (_workers + 1);
+    queue& q = _queues[index];
+    std::lock_guard lock(q.mutex);
+    if (q.tasks.empty()) {
+      continue;
+    }
+    // newest own task is hottest in cache, oldest foreign one is the largest
+    if (i == 0) {
+      t = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    } else {
+      t = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    }
+  }
+  if (!t) {
+    return false;
+  }
+  _queued.fetch_sub(1);
+  t();
+  return true;
+}
+
+inline void thread_pool::worker_loop(size_t index) noexcept {
+  _current_pool = this;
+  _current_index = index;
+  while (true) {
+    // read before looking for work, so a push in between ends the wait at once
+    uint32_t signal = _signal.load();
+    if (run_one()) {
+      continue;
+    }
+    if (_stop.load() && _queued.load() == 0) {
+      return;
+    }
+    _signal.wait(signal);
+  }
+}
+
+inline size_t thread_pool::own_queue() const noexcept {
+  return _current_pool == this ? _current_index : _workers;
+}
+
+inline task_group::task_group(thread_pool& pool) noexcept
+    : _pool(pool) {}
+
+inline task_group::~task_group() noexcept {
+  drain();
+}
+
+template <typename F>
+void task_group::run(F&& f) {
+  _pending.fetch_add(1);
+  try {
+    _pool.push([this, f = std::optional<std::decay_t<F>>(std::forward<F>(f))]() mutable {
+      std::exception_ptr error;
+      if (!_failed.load(std::memory_order_relaxed)) {
+        try {
+          (*f)();
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+      // the captured state may refer to objects the waiter destroys as soon
+      // as the group is done, so it goes first
+      f.reset();
+      finish(error);
+    });
+  } catch (...) {
+    _pending.fetch_sub(1);
+    throw;
+  }
+}
+
+inline void task_group::wait() {
+  drain();
+  if (_failed.load()) {
+    std::exception_ptr error = std::exchange(_error, nullptr);
+    _failed.store(false);
+    std::rethrow_exception(error);
+  }
+}
+
+inline void task_group::drain() noexcept {
+  while (true) {
+    // read before checking, so a task finishing or queued in between ends the wait at once
+    uint32_t progress = _pool._progress.load();
+    if (_pending.load() == 0) {
+      return;
+    }
+    if (!_pool.run_one()) {
+      _pool._progress.wait(progress);
+    }
+  }
+}
+
+inline void task_group::finish(std::exception_ptr error) noexcept {
+  if (error != nullptr) {
+    std::lock_guard lock(_error_mutex);
+    if (_error == nullptr) {
+      _error = error;
+      _failed.store(true);
+    }
+  }
+  // the waiter may destroy the group right after the decrement
+  thread_pool& pool = _pool;
+  _pending.fetch_sub(1);
+  pool._progress.fetch_add(1);
+  pool._progress.notify_all();
+}
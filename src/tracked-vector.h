@@ -0,0 +1,325 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Half-open range [first, last) of element indices.
+struct dirty_range {
+  size_t first;
+  size_t last;
+
+  bool operator==(const dirty_range&) const = default;
+};
+
+// What changed in a tracked_vector since the previous take_changes(): its size
+// and the modified elements, one view per coalesced range. The views point
+// into the tracked vector and are invalidated by its next mutation.
+template <typename T>
+struct tracked_changes {
+  struct range {
+    size_t first;
+    vector_view<const T> values;
+  };
+
+  size_t size;
+  vector<range> ranges;
+};
+
+// vector that records which indices were written since the last
+// take_changes(), so a replica only has to receive the changed elements.
+//
+// Writes go through operator[]'s proxy, push_back, insert, erase and modify();
+// anything written some other way has to be reported with mark_dirty().
+// Overlapping and adjacent ranges are merged. Insert and erase mark every
+// index from the position to the end, as those elements shift.
+template <typename T, typename Policy = vector_policy>
+class tracked_vector {
+public:
+  using value_type = T;
+
+  using const_reference = const T&;
+  using const_pointer = const T*;
+  using const_iterator = const_pointer;
+
+  // Write proxy returned by operator[].
+  class reference {
+  public:
+    // O(log R)* strong, R being the number of dirty ranges
+    reference& operator=(const T& value) {
+      _owner->mark_dirty(_index);
+      _owner->_values[_index] = value;
+      return *this;
+    }
+
+    // O(log R)* strong
+    reference& operator=(const reference& other) {
+      return *this = static_cast<const T&>(other);
+    }
+
+    // O(1) nothrow
+    operator const T&() const noexcept {
+      return _owner->_values[_index];
+    }
+
+  private:
+    friend class tracked_vector;
+
+    reference(tracked_vector* owner, size_t index) noexcept
+        : _owner(owner)
+        , _index(index) {}
+
+    tracked_vector* _owner;
+    size_t _index;
+  };
+
+  // O(1) nothrow
+  tracked_vector() noexcept = default;
+
+  // O(N) strong, starts with every element dirty
+  explicit tracked_vector(const vector<T, Policy>& values);
+
+  // O(1) nothrow
+  reference operator[](size_t index) noexcept;
+
+  // O(1) nothrow
+  const_reference operator[](size_t index) const noexcept;
+
+  // O(1) nothrow
+  const_pointer data() const noexcept;
+
+  // O(1) nothrow
+  size_t size() const noexcept;
+
+  // O(1) nothrow
+  bool empty() const noexcept;
+
+  // O(1) nothrow
+  const_iterator begin() const noexcept;
+
+  // O(1) nothrow
+  const_iterator end() const noexcept;
+
+  // O(1) nothrow
+  const vector<T, Policy>& values() const noexcept;
+
+  // O(log R)* strong, reports count elements starting at first as written
+  void mark_dirty(size_t first, size_t count = 1);
+
+  // O(log R)* strong, marks the range dirty and returns it for writing
+  vector_view<T> modify(size_t first, size_t count);
+
+  // O(1)* strong
+  void push_back(const T& value);
+
+  // O(1) nothrow
+  void pop_back() noexcept;
+
+  // O(N) strong
+  void insert(size_t index, const T& value);
+
+  // O(N) basic
+  void erase(size_t first, size_t count = 1);
+
+  // O(N) nothrow, keeps the size change as the only change
+  void clear() noexcept;
+
+  // O(N) strong
+  void reserve(size_t new_capacity);
+
+  // O(1) nothrow, coalesced dirty ranges in ascending order
+  vector_view<const dirty_range> dirty() const noexcept;
+
+  // O(R) strong, the changes since the previous call; forgets them
+  tracked_changes<T> take_changes();
+
+private:
+  // drops dirty indices at or past size()
+  void clip() noexcept;
+
+  vector<T, Policy> _values;
+  vector<dirty_range> _dirty;
+};
+
+// O(N) basic, brings a replica that matched the tracked vector at the previous
+// take_changes() up to date
+template <typename T, typename Policy>
+void apply_changes(vector<T, Policy>& replica, const tracked_changes<T>& changes);
+
+template <typename T, typename Policy>
+tracked_vector<T, Policy>::tracked_vector(const vector<T, Policy>& values)
+    : _values(values) {
+  mark_dirty(0, _values.size());
+}
+
+template <typename T, typename Policy>
+typename tracked_vector<T, Policy>::reference tracked_vector<T, Policy>::operator[](size_t index) noexcept {
+  return reference(this, index);
+}
+
+template <typename T, typename Policy>
+const T& tracked_vector<T, Policy>::operator[](size_t index) const noexcept {
+  return _values[index];
+}
+
+template <typename T, typename Policy>
+const T* tracked_vector<T, Policy>::data() const noexcept {
+  return _values.data();
+}
+
+template <typename T, typename Policy>
+size_t tracked_vector<T, Policy>::size() const noexcept {
+  return _values.size();
+}
+
+template <typename T, typename Policy>
+bool tracked_vector<T, Policy>::empty() const noexcept {
+  return _values.empty();
+}
+
+template <typename T, typename Policy>
+const T* tracked_vector<T, Policy>::begin() const noexcept {
+  return _values.begin();
+}
+
+template <typename T, typename Policy>
+const T* tracked_vector<T, Policy>::end() const noexcept {
+  return _values.end();
+}
+
+template <typename T, typename Policy>
+const vector<T, Policy>& tracked_vector<T, Policy>::values() const noexcept {
+  return _values;
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::mark_dirty(size_t first, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  size_t last = first + count;
+
+  // the first range ending at or after first; ranges touching [first, last) merge with it
+  dirty_range* begin = std::lower_bound(_dirty.begin(), _dirty.end(), first,
+                                        [](const dirty_range& r, size_t index) { return r.last < index; });
+  dirty_range* end = begin;
+  while (end != _dirty.end() && end->first <= last) {
+    first = std::min(first, end->first);
+    last = std::max(last, end->last);
+    ++end;
+  }
+
+  if (begin == end) {
+    _dirty.insert(begin, dirty_range{first, last});
+    return;
+  }
+  *begin = dirty_range{first, last};
+  if (end - begin > 1) {
+    _dirty.erase(begin + 1, end);
+  }
+}
+
+template <typename T, typename Policy>
+vector_view<T> tracked_vector<T, Policy>::modify(size_t first, size_t count) {
+  vector_view<T> range = _values.view(first, count);
+  mark_dirty(first, range.size());
+  return range;
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::push_back(const T& value) {
+  mark_dirty(_values.size());
+  try {
+    _values.push_back(value);
+  } catch (...) {
+    clip();
+    throw;
+  }
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::pop_back() noexcept {
+  _values.pop_back();
+  clip();
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::insert(size_t index, const T& value) {
+  vector<dirty_range> old_dirty = _dirty;
+  mark_dirty(index, _values.size() + 1 - index);
+  try {
+    _values.insert(_values.begin() + index, value);
+  } catch (...) {
+    _dirty.swap(old_dirty);
+    throw;
+  }
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::erase(size_t first, size_t count) {
+  // marked first: a throwing shift may already have overwritten some of them
+  mark_dirty(first, _values.size() - first);
+  try {
+    _values.erase(_values.begin() + first, _values.begin() + first + count);
+  } catch (...) {
+    clip();
+    throw;
+  }
+  clip();
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::clear() noexcept {
+  _values.clear();
+  _dirty.clear();
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::reserve(size_t new_capacity) {
+  _values.reserve(new_capacity);
+}
+
+template <typename T, typename Policy>
+vector_view<const dirty_range> tracked_vector<T, Policy>::dirty() const noexcept {
+  return _dirty.view();
+}
+
+template <typename T, typename Policy>
+tracked_changes<T> tracked_vector<T, Policy>::take_changes() {
+  tracked_changes<T> changes{_values.size(), {}};
+  changes.ranges.reserve(_dirty.size());
+  for (const dirty_range& r : _dirty) {
+    changes.ranges.push_back({r.first, _values.view(r.first, r.last - r.first)});
+  }
+  _dirty.clear();
+  return changes;
+}
+
+template <typename T, typename Policy>
+void tracked_vector<T, Policy>::clip() noexcept {
+  size_t size = _values.size();
+  while (!_dirty.empty() && _dirty.back().first >= size) {
+    _dirty.pop_back();
+  }
+  if (!_dirty.empty()) {
+    _dirty.back().last = std::min(_dirty.back().last, size);
+  }
+}
+
+template <typename T, typename Policy>
+void apply_changes(vector<T, Policy>& replica, const tracked_changes<T>& changes) {
+  while (replica.size() > changes.size) {
+    replica.pop_back();
+  }
+  for (const typename tracked_changes<T>::range& r : changes.ranges) {
+    for (size_t i = 0; i < r.values.size(); ++i) {
+      if (r.first + i < replica.size()) {
+        replica[r.first + i] = r.values[i];
+      } else {
+        replica.push_back(r.values[i]);
+      }
+    }
+  }
+}
@@ -0,0 +1,398 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+#ifdef VECTOR_HAVE_POSIX_IO
+#include <csignal>
+#include <thread>
+#endif
+
+// Memory held by one registered vector.
+struct vector_usage {
+  const char* type;
+  const void* address;
+  size_t size;
+  size_t capacity;
+  // capacity and unused capacity, in bytes
+  size_t bytes;
+  size_t slack_bytes;
+};
+
+// Memory held by all registered vectors of one type.
+struct vector_type_usage {
+  const char* type;
+  size_t instances;
+  size_t bytes;
+  size_t slack_bytes;
+};
+
+// Snapshot of the registered vectors taken by vector_registry::report().
+struct vector_report {
+  size_t instances = 0;
+  size_t bytes = 0;
+  size_t slack_bytes = 0;
+  // every type, by bytes, largest first
+  vector<vector_type_usage> types;
+  // the top instances by bytes and by slack_bytes
+  vector<vector_usage> largest;
+  vector<vector_usage> most_wasteful;
+
+  // O(types + top) basic, human-readable table
+  void write(std::ostream& out) const;
+};
+
+// Process-wide list of the live registered_vector instances, for finding out
+// where memory goes and which vectors would gain from shrink_to_fit() or a
+// better reserve(). Plain vectors are not tracked and pay nothing.
+//
+// report() reads the size and capacity of every registered vector without
+// synchronizing with their owners, so it must run while none of them is being
+// modified; the signal dump is a debugging aid under the same condition.
+class vector_registry {
+public:
+  // Intrusive list entry embedded in every registered vector.
+  struct node {
+    const void* object;
+    const char* type;
+    size_t element_size;
+    std::pair<size_t, size_t> (*measure)(const void* object) noexcept;
+    node* prev = nullptr;
+    node* next = nullptr;
+  };
+
+  // O(1) nothrow
+  vector_registry() = default;
+
+  vector_registry(const vector_registry&) = delete;
+  vector_registry& operator=(const vector_registry&) = delete;
+
+  // O(1) nothrow, the registry used by registered_vector
+  static vector_registry& global() noexcept;
+
+  // O(1) nothrow
+  void add(node& n) noexcept;
+
+  // O(1) nothrow
+  void remove(node& n) noexcept;
+
+  // O(1) nothrow
+  size_t instances() const noexcept;
+
+  // O(R log top) strong, R being the number of registered vectors
+  vector_report report(size_t top = 10) const;
+
+#ifdef VECTOR_HAVE_POSIX_IO
+  // O(1) strong, starts a thread writing report() of the global registry to fd
+  // whenever the process receives signo; succeeds at most once per process
+  static void dump_on_signal(int signo = SIGUSR1, int fd = STDERR_FILENO);
+#endif
+
+private:
+  mutable std::mutex _mutex;
+  node* _head = nullptr;
+  size_t _instances = 0;
+
+#ifdef VECTOR_HAVE_POSIX_IO
+  inline static std::atomic<bool> _dump_installed{false};
+  inline static int _dump_pipe[2] = {-1, -1};
+#endif
+};
+
+namespace vector_registry_detail {
+
+// readable name of T, computed once
+template <typename T>
+const char* type_name() {
+  static const std::string name = [] {
+    const char* mangled = typeid(T).name();
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (demangled != nullptr) {
+      std::string result(demangled);
+      std::free(demangled);
+      return result;
+    }
+#endif
+    return std::string(mangled);
+  }();
+  return name.c_str();
+}
+
+} // namespace vector_registry_detail
+
+// vector that stays in vector_registry::global() for as long as it lives.
+// Moved-from vectors stay registered with whatever they are left holding.
+template <typename T, typename Policy = vector_policy>
+class registered_vector : public vector<T, Policy> {
+public:
+  // O(1) strong
+  registered_vector();
+
+  // O(1) strong, takes over the buffer of values
+  explicit registered_vector(vector<T, Policy>&& values);
+
+  // O(N) strong
+  registered_vector(const registered_vector& other);
+
+  // O(1) nothrow
+  registered_vector(registered_vector&& other) noexcept;
+
+  // O(N) strong
+  registered_vector& operator=(const registered_vector& other);
+
+  // O(1) nothrow
+  registered_vector& operator=(registered_vector&& other) noexcept;
+
+  // O(N) nothrow
+  ~registered_vector() noexcept;
+
+private:
+  static std::pair<size_t, size_t> measure(const void* object) noexcept;
+
+  // registers this object; the node is filled in here, not copied
+  void enlist(const char* type) noexcept;
+
+  vector_registry::node _node{};
+};
+
+inline void vector_report::write(std::ostream& out) const {
+  out << "vectors: " << instances << ", bytes: " << bytes << ", slack bytes: " << slack_bytes << '\n';
+  out << "by type:\n";
+  for (const vector_type_usage& t : types) {
+    out << "  " << t.type << ": " << t.instances << " instances, " << t.bytes << " bytes, " << t.slack_bytes
+        << " slack\n";
+  }
+  auto write_instances = [&](const char* title, const vector<vector_usage>& list) {
+    out << title << ":\n";
+    for (const vector_usage& u : list) {
+      out << "  " << u.type << " at " << u.address << ": size " << u.size << ", capacity " << u.capacity << ", "
+          << u.bytes << " bytes, " << u.slack_bytes << " slack\n";
+    }
+  };
+  write_instances("largest", largest);
+  write_instances("most wasteful", most_wasteful);
+}
+
+inline vector_registry& vector_registry::global() noexcept {
+  static vector_registry registry;
+  return registry;
+}
+
+inline void vector_registry::add(node& n) noexcept {
+  std::lock_guard lock(_mutex);
+  n.prev = nullptr;
+  n.next = _head;
+  if (_head != nullptr) {
+    _head->prev = &n;
+  }
+  _head = &n;
+  ++_instances;
+}
+
+inline void vector_registry::remove(node& n) noexcept {
+  std::lock_guard lock(_mutex);
+  if (n.prev != nullptr) {
+    n.prev->next = n.next;
+  } else {
+    _head = n.next;
+  }
+  if (n.next != nullptr) {
+    n.next->prev = n.prev;
+  }
+  n.prev = n.next = nullptr;
+  --_instances;
+}
+
+inline size_t vector_registry::instances() const noexcept {
+  std::lock_guard lock(_mutex);
+  return _instances;
+}
+
+inline vector_report vector_registry::report(size_t top) const {
+  vector_report result;
+  vector<vector_usage> all;
+  {
+    std::lock_guard lock(_mutex);
+    all.reserve(_instances);
+    for (const node* n = _head; n != nullptr; n = n->next) {
+      auto [size, capacity] = n->measure(n->object);
+      all.push_back({n->type, n->object, size, capacity, capacity * n->element_size,
+                     (capacity - size) * n->element_size});
+    }
+  }
+
+  std::unordered_map<const char*, size_t> type_index;
+  for (const vector_usage& u : all) {
+    auto [it, inserted] = type_index.emplace(u.type, result.types.size());
+    if (inserted) {
+      result.types.push_back({u.type, 0, 0, 0});
+    }
+    vector_type_usage& t = result.types[it->second];
+    ++t.instances;
+    t.bytes += u.bytes;
+    t.slack_bytes += u.slack_bytes;
+    ++result.instances;
+    result.bytes += u.bytes;
+    result.slack_bytes += u.slack_bytes;
+  }
+  std::sort(result.types.begin(), result.types.end(),
+            [](const vector_type_usage& lhs, const vector_type_usage& rhs) { return lhs.bytes > rhs.bytes; });
+
+  auto select = [&](vector<vector_usage>& out, size_t vector_usage::*key) {
+    size_t count = std::min(top, all.size());
+    std::partial_sort(all.begin(), all.begin() + count, all.end(),
+                      [key](const vector_usage& lhs, const vector_usage& rhs) { return lhs.*key > rhs.*key; });
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      out.push_back(all[i]);
+    }
+  };
+  select(result.largest, &vector_usage::bytes);
+  select(result.most_wasteful, &vector_usage::slack_bytes);
+  return result;
+}
+
+#ifdef VECTOR_HAVE_POSIX_IO
+inline void vector_registry::dump_on_signal(int signo, int fd) {
+  if (_dump_installed.exchange(true)) {
+    throw std::logic_error("vector_registry: signal dump already installed");
+  }
+  if (::pipe(_dump_pipe) != 0) {
+    _dump_installed = false;
+    throw std::system_error(errno, std::generic_category(), "pipe");
+  }
+
+  // the handler only wakes the thread; write(2) is async-signal-safe, reporting is not
+  struct sigaction action {};
+  action.sa_handler = [](int) {
+    int saved_errno = errno;
+    char byte = 0;
+    static_cast<void>(::write(_dump_pipe[1], &byte, 1));
+    errno = saved_errno;
+  };
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+
+  // installed before the thread starts, so a failure leaves nothing running;
+  // a signal arriving meanwhile waits in the pipe
+  struct sigaction previous {};
+  if (::sigaction(signo, &action, &previous) != 0) {
+    int error = errno;
+    ::close(_dump_pipe[0]);
+    ::close(_dump_pipe[1]);
+    _dump_installed = false;
+    throw std::system_error(error, std::generic_category(), "sigaction");
+  }
+
+  try {
+    std::thread([fd] {
+      char byte;
+      while (true) {
+        ssize_t n = ::read(_dump_pipe[0], &byte, 1);
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return;
+        }
+        std::ostringstream out;
+        try {
+          global().report().write(out);
+        } catch (...) {
+          out << "vector_registry: report failed\n";
+        }
+        std::string text = out.str();
+        for (size_t written = 0; written < text.size();) {
+          ssize_t w = ::write(fd, text.data() + written, text.size() - written);
+          if (w < 0 && errno == EINTR) {
+            continue;
+          }
+          if (w <= 0) {
+            break;
+          }
+          written += static_cast<size_t>(w);
+        }
+      }
+    }).detach();
+  } catch (...) {
+    ::sigaction(signo, &previous, nullptr);
+    ::close(_dump_pipe[0]);
+    ::close(_dump_pipe[1]);
+    _dump_installed = false;
+    throw;
+  }
+}
+#endif
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>::registered_vector() {
+  enlist(vector_registry_detail::type_name<vector<T, Policy>>());
+}
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>::registered_vector(vector<T, Policy>&& values)
+    : vector<T, Policy>(std::move(values)) {
+  enlist(vector_registry_detail::type_name<vector<T, Policy>>());
+}
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>::registered_vector(const registered_vector& other)
+    : vector<T, Policy>(other) {
+  enlist(other._node.type);
+}
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>::registered_vector(registered_vector&& other) noexcept
+    : vector<T, Policy>(std::move(other)) {
+  // the name was computed when other was registered
+  enlist(other._node.type);
+}
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>& registered_vector<T, Policy>::operator=(const registered_vector& other) {
+  vector<T, Policy>::operator=(other);
+  return *this;
+}
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>& registered_vector<T, Policy>::operator=(registered_vector&& other) noexcept {
+  vector<T, Policy>::operator=(std::move(other));
+  return *this;
+}
+
+template <typename T, typename Policy>
+registered_vector<T, Policy>::~registered_vector() noexcept {
+  vector_registry::global().remove(_node);
+}
+
+template <typename T, typename Policy>
+std::pair<size_t, size_t> registered_vector<T, Policy>::measure(const void* object) noexcept {
+  const vector<T, Policy>* v = static_cast<const registered_vector*>(object);
+  return {v->size(), v->capacity()};
+}
+
+template <typename T, typename Policy>
+void registered_vector<T, Policy>::enlist(const char* type) noexcept {
+  _node.object = this;
+  _node.type = type;
+  _node.element_size = sizeof(T);
+  _node.measure = &measure;
+  vector_registry::global().add(_node);
+}
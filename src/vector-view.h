@@ -0,0 +1,204 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// operator[], front() and back() of vector_view check their bounds unless
+// NDEBUG is set; define VECTOR_VIEW_CHECKED to keep the checks in release builds.
+// VECTOR_VIEW_CHECK_BOUNDS is private to this header.
+#if defined(VECTOR_VIEW_CHECKED) || !defined(NDEBUG)
+#define VECTOR_VIEW_CHECK_BOUNDS 1
+#else
+#define VECTOR_VIEW_CHECK_BOUNDS 0
+#endif
+
+template <typename T>
+class vector_view;
+
+template <typename Range, typename T>
+concept viewable_range_of =
+    !std::is_same_v<std::remove_cvref_t<Range>, vector_view<T>> &&
+    (std::is_lvalue_reference_v<Range> || std::ranges::borrowed_range<Range>) && requires(Range& r) {
+      // qualification conversions only, as for std::span: a Derived* would
+      // convert to a Base* but be stepped through with the wrong stride
+      requires std::is_convertible_v<std::remove_pointer_t<decltype(r.data())> (*)[], T (*)[]>;
+      { r.size() } -> std::convertible_to<size_t>;
+    };
+
+// Non-owning (pointer, size) window into contiguous elements: a vector, a
+// std::span, a std::string or any other buffer with data() and size(). vector_view<const T> is the
+// read-only flavour, and a vector_view<T> converts to it implicitly.
+//
+// A view does not extend the lifetime of what it looks at; anything that
+// reallocates the underlying buffer invalidates it.
+template <typename T>
+class vector_view {
+public:
+  using value_type = std::remove_cv_t<T>;
+
+  using reference = T&;
+  using pointer = T*;
+
+  using iterator = pointer;
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  // O(1) nothrow
+  constexpr vector_view() noexcept = default;
+
+  // O(1) nothrow
+  constexpr vector_view(T* data, size_t size) noexcept;
+
+  // O(1) nothrow, any contiguous container with data() and size(), including
+  // std::span and vector_view<U> for vector_view<const U>; temporaries only
+  // when they do not own their elements
+  template <typename Range>
+    requires viewable_range_of<Range, T>
+  constexpr vector_view(Range&& range) noexcept;
+
+  // O(1) nothrow
+  constexpr operator std::span<T>() const noexcept;
+
+  // O(1) nothrow
+  constexpr std::span<T> span() const noexcept;
+
+  // O(1), throws std::out_of_range in VECTOR_VIEW_CHECKED builds
+  constexpr reference operator[](size_t index) const;
+
+  // O(1), throws std::out_of_range
+  constexpr reference at(size_t index) const;
+
+  // O(1), throws std::out_of_range in VECTOR_VIEW_CHECKED builds
+  constexpr reference front() const;
+
+  // O(1), throws std::out_of_range in VECTOR_VIEW_CHECKED builds
+  constexpr reference back() const;
+
+  // O(1) nothrow
+  constexpr pointer data() const noexcept;
+
+  // O(1) nothrow
+  constexpr size_t size() const noexcept;
+
+  // O(1) nothrow
+  constexpr bool empty() const noexcept;
+
+  // O(1) nothrow
+  constexpr iterator begin() const noexcept;
+
+  // O(1) nothrow
+  constexpr iterator end() const noexcept;
+
+  // O(1), at most count elements starting at first; throws std::out_of_range
+  // when first > size()
+  constexpr vector_view subview(size_t first, size_t count = npos) const;
+
+private:
+  constexpr void check(size_t index) const;
+
+  T* _data = nullptr;
+  size_t _size = 0;
+};
+
+template <typename Range>
+vector_view(Range&&) -> vector_view<std::remove_pointer_t<decltype(std::declval<Range&>().data())>>;
+
+// Views may outlive the view object they were taken from.
+template <typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<vector_view<T>> = true;
+
+template <typename T>
+constexpr vector_view<T>::vector_view(T* data, size_t size) noexcept
+    : _data(data)
+    , _size(size) {}
+
+template <typename T>
+template <typename Range>
+  requires viewable_range_of<Range, T>
+constexpr vector_view<T>::vector_view(Range&& range) noexcept
+    : _data(range.data())
+    , _size(range.size()) {}
+
+template <typename T>
+constexpr vector_view<T>::operator std::span<T>() const noexcept {
+  return std::span<T>(_data, _size);
+}
+
+template <typename T>
+constexpr std::span<T> vector_view<T>::span() const noexcept {
+  return std::span<T>(_data, _size);
+}
+
+template <typename T>
+constexpr T& vector_view<T>::operator[](size_t index) const {
+  check(index);
+  return _data[index];
+}
+
+template <typename T>
+constexpr T& vector_view<T>::at(size_t index) const {
+  if (index >= _size) {
+    throw std::out_of_range("vector_view::at");
+  }
+  return _data[index];
+}
+
+template <typename T>
+constexpr T& vector_view<T>::front() const {
+  check(0);
+  return _data[0];
+}
+
+template <typename T>
+constexpr T& vector_view<T>::back() const {
+  check(0);
+  return _data[_size - 1];
+}
+
+template <typename T>
+constexpr T* vector_view<T>::data() const noexcept {
+  return _data;
+}
+
+template <typename T>
+constexpr size_t vector_view<T>::size() const noexcept {
+  return _size;
+}
+
+template <typename T>
+constexpr bool vector_view<T>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T>
+constexpr T* vector_view<T>::begin() const noexcept {
+  return _data;
+}
+
+template <typename T>
+constexpr T* vector_view<T>::end() const noexcept {
+  return _data + _size;
+}
+
+template <typename T>
+constexpr vector_view<T> vector_view<T>::subview(size_t first, size_t count) const {
+  if (first > _size) {
+    throw std::out_of_range("vector_view::subview");
+  }
+  return vector_view(_data + first, count < _size - first ? count : _size - first);
+}
+
+template <typename T>
+constexpr void vector_view<T>::check([[maybe_unused]] size_t index) const {
+#if VECTOR_VIEW_CHECK_BOUNDS
+  if (index >= _size) {
+    throw std::out_of_range("vector_view: index out of range");
+  }
+#endif
+}
+
+#undef VECTOR_VIEW_CHECK_BOUNDS
@@ -1,9 +1,195 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bulk-hash.h"
+#include "vector-view.h"
+
+#if __has_include(<unistd.h>)
+#define VECTOR_HAVE_POSIX_IO
+#include <cerrno>
+#include <system_error>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__) && __has_include(<malloc.h>)
+#define VECTOR_HAVE_MALLOC_USABLE_SIZE
+#include <malloc.h>
+#endif
+
+// Allocation hooks used by vector. Requests whose alignment exceeds what plain
+// operator new guarantees go through the std::align_val_t overloads.
+//
+// With VECTOR_HAVE_SIZE_RETURNING_NEW, allocate() raises `bytes` to the size
+// the allocator reports for the returned block, so growth can claim the slack
+// it hands out anyway; deallocate() then accepts any size between the
+// requested and the reported one. Plain operator new may be replaced, so its
+// blocks are never measured behind its back and keep the requested size; see
+// malloc_policy for claiming glibc's slack.
+struct vector_policy {
+  static void* allocate(size_t& bytes, size_t alignment) {
+#ifdef VECTOR_HAVE_SIZE_RETURNING_NEW
+    // tcmalloc and other allocators implementing P0901
+    __sized_ptr_t result = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                             ? __size_returning_new_aligned(bytes, std::align_val_t{alignment})
+                             : __size_returning_new(bytes);
+    bytes = result.n;
+    return result.p;
+#else
+    return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? operator new(bytes, std::align_val_t{alignment})
+                                                        : operator new(bytes);
+#endif
+  }
+
+  static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+#ifdef __cpp_sized_deallocation
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      operator delete(ptr, bytes, std::align_val_t{alignment});
+    } else {
+      operator delete(ptr, bytes);
+    }
+#else
+    static_cast<void>(bytes);
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      operator delete(ptr, std::align_val_t{alignment});
+    } else {
+      operator delete(ptr);
+    }
+#endif
+  }
+};
+
+#ifdef VECTOR_HAVE_MALLOC_USABLE_SIZE
+// Allocates with malloc and raises `bytes` to malloc_usable_size(), so growth
+// claims the slack glibc rounds every block up to. Blocks are released with
+// free, whatever size between the requested and the reported one is passed.
+// Allocations bypass operator new and any replacement of it.
+struct malloc_policy {
+  static void* allocate(size_t& bytes, size_t alignment) {
+    void* ptr = alignment > alignof(std::max_align_t)
+                  ? std::aligned_alloc(alignment, (bytes + alignment - 1) & ~(alignment - 1))
+                  : std::malloc(bytes);
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    bytes = malloc_usable_size(ptr);
+    return ptr;
+  }
+
+  static void deallocate(void* ptr, size_t, size_t) noexcept {
+    std::free(ptr);
+  }
+};
+#endif
+
+// Raises the alignment of every allocation to at least Align bytes.
+template <size_t Align>
+struct aligned_policy : vector_policy {
+  static_assert(Align > 0 && (Align & (Align - 1)) == 0, "alignment must be a power of two");
+
+  static void* allocate(size_t& bytes, size_t alignment) {
+    return vector_policy::allocate(bytes, std::max(Align, alignment));
+  }
+
+  static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+    vector_policy::deallocate(ptr, bytes, std::max(Align, alignment));
+  }
+};
+
+// Lets vector hand memory back on its own: when pop_back or erase leave fewer
+// than capacity / 4 elements, the buffer is reallocated to about twice the
+// size, and clear() frees it outright. The size has to halve again before the
+// next shrink, so alternating pushes and pops cannot thrash. Buffers of at most
+// MinBytes are left alone. Unlike with the other policies, pop_back and erase
+// can then invalidate every pointer and iterator into the vector, not only
+// those at or after the removed elements.
+template <typename Base = vector_policy, size_t MinBytes = 1024>
+struct shrinking_policy : Base {
+  static constexpr bool auto_shrink = true;
+  static constexpr size_t min_shrink_bytes = MinBytes;
+};
+
+template <typename Policy>
+concept auto_shrinking_policy = requires { requires Policy::auto_shrink; };
+
+// Keeps push_back, insert and the fd reads going near the memory limit: when
+// the doubled buffer cannot be allocated (std::bad_alloc), growth is retried
+// adding Percents% of the capacity, in the order given, and finally with just
+// the room required. Only the exception of the last attempt escapes, and the
+// vector is unchanged then. Example: fallback_growth_policy<vector_policy, 50, 25>.
+template <typename Base = vector_policy, unsigned... Percents>
+struct fallback_growth_policy : Base {
+  static constexpr std::array<unsigned, sizeof...(Percents)> growth_fallback = {Percents...};
+};
+
+template <typename Policy>
+concept growth_falling_back_policy = requires { Policy::growth_fallback; };
+
+// Stores size and capacity as SizeType, so the vector object is a pointer plus
+// two counts: 16 bytes with uint32_t instead of 24. Growing past the largest
+// SizeType throws std::length_error.
+template <typename SizeType = uint32_t, typename Base = vector_policy>
+struct compact_policy : Base {
+  static_assert(std::is_unsigned_v<SizeType>, "size type must be unsigned");
+
+  using size_type = SizeType;
+};
+
+// Policy::size_type if the policy has one, size_t otherwise.
+template <typename Policy>
+struct policy_size_type {
+  using type = size_t;
+};
+
+template <typename Policy>
+  requires requires { typename Policy::size_type; }
+struct policy_size_type<Policy> {
+  using type = typename Policy::size_type;
+};
+
+// Element types that may be filled directly by read(2).
+template <typename T>
+concept byte_like = std::is_same_v<T, char> || std::is_same_v<T, unsigned char> || std::is_same_v<T, std::byte>;
+
+// Element types whose values are equal exactly when their bytes are: vector
+// compares them with memcmp and hashes data() with bulk_hash. Specialize
+// enable_trivially_comparable for trivially copyable types without padding or
+// floating-point members to opt in.
+template <typename T>
+inline constexpr bool enable_trivially_comparable = false;
 
 template <typename T>
+concept trivially_comparable =
+    std::is_integral_v<T> || std::is_enum_v<T> || (enable_trivially_comparable<T> && std::is_trivially_copyable_v<T>);
+
+// Types whose objects may move to another address by a plain byte copy,
+// after which the original is forgotten without running its destructor.
+// Trivially copyable types qualify; specialize enable_trivially_relocatable to
+// opt in others that hold no pointers into themselves. vector relocates such
+// elements with memcpy when it reallocates.
+template <typename T>
+inline constexpr bool enable_trivially_relocatable = false;
+
+template <typename T>
+concept trivially_relocatable = std::is_trivially_copyable_v<T> || enable_trivially_relocatable<T>;
+
+template <typename T, typename Policy = vector_policy>
 class vector {
 
 public:
@@ -18,12 +204,63 @@ public:
   using iterator = pointer;
   using const_iterator = const_pointer;
 
+  // type of the stored size and capacity; the interface always uses size_t
+  using size_type = typename policy_size_type<Policy>::type;
+
 private:
+  static constexpr size_t max_elements = std::min<size_t>(SIZE_MAX / sizeof(T), std::numeric_limits<size_type>::max());
+
   pointer _data;
-  size_t _size, _capacity, _cur_index;
+  size_type _size, _capacity;
 
   void copy(const vector& other);
 
+  // O(1) strong
+  static pointer allocate(size_t count);
+
+  // O(1) strong, raises count to the number of elements the block can hold;
+  // count must not be 0
+  static pointer allocate_at_least(size_t& count);
+
+  // O(1) nothrow
+  static void deallocate(pointer ptr, size_t count) noexcept;
+
+  // O(N) strong, moves or copies count elements to uninitialized memory at
+  // `to`, leaving the originals for destroy_relocated(); trivially relocatable
+  // elements are copied as bytes
+  static void relocate(pointer from, size_t count, pointer to);
+
+  // O(N) nothrow, ends the lifetime of elements relocate() took from
+  static void destroy_relocated(pointer from, size_t count) noexcept;
+
+  // O(N) nothrow, destroys count elements back to front; no loop at all for
+  // trivially destructible T
+  static void destroy(pointer first, size_t count) noexcept;
+
+  // O(N) strong, moves the elements to a new buffer allocated by the caller
+  void replace_buffer(pointer new_data, size_t new_capacity);
+
+  // O(1) nothrow, capacity to grow to when `required` elements do not fit
+  size_t next_capacity(size_t required) const noexcept;
+
+  // O(1) strong, buffer of next_capacity(required) elements, or of the smaller
+  // fallback capacities of the policy if that allocation fails
+  pointer allocate_for_growth(size_t required, size_t& new_capacity);
+
+  // O(N) strong, room for count more elements; std::length_error past max_size()
+  void grow_for_append(size_t count) requires byte_like<T>;
+
+  // O(1) nothrow, how much of a read of at most max bytes to make room for:
+  // all of the spare capacity, but growth only up to doubling the vector, or
+  // up to min_read_growth bytes for small ones
+  size_t read_size(size_t max) const noexcept requires byte_like<T>;
+
+  static constexpr size_t min_read_growth = size_t(64) * 1024;
+
+  // O(N) nothrow, applies shrinking_policy after elements were removed; keeps
+  // the current buffer if the smaller one cannot be allocated or filled
+  void shrink_after_erase() noexcept;
+
 public:
   // O(1) nothrow
   vector() noexcept;
@@ -31,14 +268,14 @@ public:
   // O(N) strong
   vector(const vector& other);
 
-  // O(1) strong
-  vector(vector&& other);
+  // O(1) nothrow
+  vector(vector&& other) noexcept;
 
   // O(N) strong
   vector& operator=(const vector& other);
 
-  // O(1) strong
-  vector& operator=(vector&& other);
+  // O(1) nothrow
+  vector& operator=(vector&& other) noexcept;
 
   // O(N) nothrow
   ~vector() noexcept;
@@ -82,17 +319,23 @@ public:
   // O(1) nothrow
   size_t capacity() const noexcept;
 
+  // O(1) nothrow
+  size_t max_size() const noexcept;
+
   // O(N) strong
   void reserve(size_t new_capacity);
 
+  // O(N) strong, value-initializes the elements past the old size
+  void resize(size_t new_size) requires std::default_initializable<T>;
+
   // // O(N) strong
   void shrink_to_fit();
 
-  // O(N) nothrow
+  // O(N) nothrow, under shrinking_policy frees a buffer of more than MinBytes
   void clear() noexcept;
 
-  // // O(1) nothrow
-  // void swap(vector& other) noexcept;
+  // O(1) nothrow
+  void swap(vector& other) noexcept;
 
   // // O(1) nothrow
   iterator begin() noexcept;
@@ -106,6 +349,19 @@ public:
   // // O(1) nothrow
   const_iterator end() const noexcept;
 
+  // O(1) nothrow
+  vector_view<T> view() noexcept;
+
+  // O(1) nothrow
+  vector_view<const T> view() const noexcept;
+
+  // O(1), at most count elements starting at first; throws std::out_of_range
+  // when first > size()
+  vector_view<T> view(size_t first, size_t count = vector_view<T>::npos);
+
+  // O(1), same as above
+  vector_view<const T> view(size_t first, size_t count = vector_view<T>::npos) const;
+
   // // O(N) strong
   iterator insert(const_iterator pos, const T& value);
 
@@ -114,25 +370,182 @@ public:
 
   // // O(N) nothrow(swap)
   iterator erase(const_iterator first, const_iterator last);
+
+#ifdef VECTOR_HAVE_POSIX_IO
+  // O(max) strong, reads at most max bytes from fd straight into the tail;
+  // returns the number of bytes read, 0 at end of file. A single call reads
+  // no more than the spare capacity, the current size or 64 KiB, whichever is
+  // largest, so a large max does not reserve memory the read may never fill.
+  size_t append_from_fd(int fd, size_t max) requires byte_like<T>;
+
+  // O(max) strong, same as above but uses pread() at the given offset
+  size_t append_from_fd(int fd, size_t max, off_t offset) requires byte_like<T>;
+
+  // O(N) strong, appends everything up to end of file; returns the number of
+  // bytes read. The buffer held before the call is kept until the read
+  // succeeds, so a failure leaves data() and capacity() as they were.
+  size_t read_all(int fd) requires byte_like<T>;
+#endif
 };
 
+// data() of an aligned_vector is always aligned to at least Align bytes.
+template <typename T, size_t Align = 64>
+using aligned_vector = vector<T, aligned_policy<Align>>;
 
+// vector with a 16-byte header for uint32_t, see compact_policy.
+template <typename T, typename SizeType = uint32_t>
+using compact_vector = vector<T, compact_policy<SizeType>>;
 
+// A vector is its buffer pointer and two counts, so vector<vector<T>> grows by
+// copying headers.
+template <typename T, typename Policy>
+inline constexpr bool enable_trivially_relocatable<vector<T, Policy>> = true;
 
+// O(1) nothrow
+template <typename T, typename Policy>
+void swap(vector<T, Policy>& lhs, vector<T, Policy>& rhs) noexcept;
+
+// O(N), a single memcmp for trivially_comparable T
+template <typename T, typename P1, typename P2>
+  requires std::equality_comparable<T>
+bool operator==(const vector<T, P1>& lhs, const vector<T, P2>& rhs);
+
+// O(N), lexicographic; a single memcmp for unsigned bytes
+template <typename T, typename P1, typename P2>
+  requires std::three_way_comparable<T>
+std::compare_three_way_result_t<T> operator<=>(const vector<T, P1>& lhs, const vector<T, P2>& rhs);
+
+// bulk_hash of data() for trivially_comparable T, a combination of the
+// element hashes otherwise
+template <typename T, typename Policy>
+  requires trivially_comparable<T> || requires(const T& value) { std::hash<T>()(value); }
+struct std::hash<vector<T, Policy>> {
+  // O(N)
+  size_t operator()(const ::vector<T, Policy>& a) const noexcept(trivially_comparable<T>);
+};
+
+template <typename T, typename Policy>
+vector<T, Policy>::vector() noexcept : _data{nullptr}, _size{0}, _capacity{0} {
+    //printf("constructor vector() called\n");
+}
 
+template <typename T, typename Policy>
+T* vector<T, Policy>::allocate(size_t count) {
+    if (count == 0) {
+        return nullptr;
+    }
+    size_t capacity = count;
+    return allocate_at_least(capacity);
+}
 
+template <typename T, typename Policy>
+T* vector<T, Policy>::allocate_at_least(size_t& count) {
+    // no object may span more than PTRDIFF_MAX bytes
+    if (count > PTRDIFF_MAX / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    if (count > max_elements) {
+        throw std::length_error("vector: capacity exceeds size_type");
+    }
+    size_t bytes = count * sizeof(T);
+    T* ptr = static_cast<T*>(Policy::allocate(bytes, alignof(T)));
+    count = std::clamp(bytes / sizeof(T), count, max_elements);
+    return ptr;
+}
 
-template<typename T>
-vector<T>::vector() noexcept : _data{nullptr}, _size{0}, _capacity{0}, _cur_index{0} {
-    //printf("constructor vector() called\n");
+template <typename T, typename Policy>
+void vector<T, Policy>::deallocate(T* ptr, size_t count) noexcept {
+    if (ptr != nullptr) {
+        Policy::deallocate(ptr, count * sizeof(T), alignof(T));
+    }
+}
+
+template <typename T, typename Policy>
+size_t vector<T, Policy>::next_capacity(size_t required) const noexcept {
+    size_t grown = _capacity == 0 ? size_t(2) : size_t(_capacity) * 2;
+    return std::max(required, std::min(grown, max_elements));
+}
+
+template <typename T, typename Policy>
+T* vector<T, Policy>::allocate_for_growth(size_t required, size_t& new_capacity) {
+  new_capacity = next_capacity(required);
+  if constexpr (growth_falling_back_policy<Policy>) {
+    auto attempt = [&](size_t capacity) -> T* {
+      new_capacity = capacity;
+      try {
+        return allocate_at_least(new_capacity);
+      } catch (const std::bad_alloc&) {
+        return nullptr;
+      }
+    };
+    size_t tried = new_capacity;
+    if (T* ptr = attempt(tried)) {
+      return ptr;
+    }
+    for (unsigned percent : Policy::growth_fallback) {
+      size_t capacity = std::max(required, size_t(_capacity) + size_t(_capacity) * percent / 100);
+      if (capacity < tried) {
+        tried = capacity;
+        if (T* ptr = attempt(capacity)) {
+          return ptr;
+        }
+      }
+    }
+    new_capacity = required;
+  }
+  return allocate_at_least(new_capacity);
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::relocate(T* from, size_t count, T* to) {
+  if constexpr (trivially_relocatable<T>) {
+    if (count > 0) {
+      std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+    }
+  } else {
+    size_t moved = 0;
+    try {
+      for (; moved < count; ++moved) {
+        new (to + moved) T(std::move_if_noexcept(from[moved]));
+      }
+    } catch (...) {
+      std::destroy_n(to, moved);
+      throw;
+    }
+  }
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::destroy_relocated(T* from, size_t count) noexcept {
+  if constexpr (!trivially_relocatable<T>) {
+    std::destroy_n(from, count);
+  }
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::destroy(T* first, size_t count) noexcept {
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    for (size_t i = count; i > 0; --i) {
+      first[i - 1].~T();
+    }
+  }
 }
 
-template<typename T>
-void vector<T>::copy(const vector& other) {    
+template <typename T, typename Policy>
+void vector<T, Policy>::replace_buffer(T* new_data, size_t new_capacity) {
+  relocate(_data, _size, new_data);
+  destroy_relocated(_data, _size);
+  deallocate(_data, _capacity);
+  _data = new_data;
+  _capacity = new_capacity;
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::copy(const vector& other) {    
     if (!other.empty())
     {
-        size_t mem_size = other.size() * sizeof(T), copied = 0;
-        _data = static_cast<T*>(operator new(mem_size));
+        size_t copied = 0;
+        _data = allocate(other.size());
         try {
             for (size_t i = 0; i < other.size(); i++) {
                 new (_data + i) T(other[i]);
@@ -142,7 +555,7 @@ void vector<T>::copy(const vector& other) {
             for (size_t i = 0; i < copied; i++) {
                 _data[i].~T();
             }
-            operator delete (_data);
+            deallocate(_data, other.size());
             _data = nullptr;
             throw;
         }
@@ -155,18 +568,18 @@ void vector<T>::copy(const vector& other) {
     //printf("copy other. new size: %lu, new cap: %lu\n", _size, _capacity);
 }
 
-template<typename T>
-vector<T>::vector(const vector &other) {
+template <typename T, typename Policy>
+vector<T, Policy>::vector(const vector &other) {
     //printf("constructor vector(& other) called\n");
     if (this == &other) {
         return;
     }
-    _data=nullptr; _size = _capacity = _cur_index = 0;
+    _data=nullptr; _size = _capacity = 0;
     copy(other);
 }
 
-template<typename T>
-vector<T>::vector(vector &&other) {
+template <typename T, typename Policy>
+vector<T, Policy>::vector(vector &&other) noexcept {
     //printf("constructor vector(&& other) called\n");
     _data = other._data;
     _size = other._size;
@@ -176,30 +589,26 @@ vector<T>::vector(vector &&other) {
     other._data = nullptr;
 }
 
-
-
   // O(N) strong
-  template<typename T>
-  vector<T>& vector<T>::operator=(const vector<T>& other) {
+  template <typename T, typename Policy>
+  vector<T, Policy>& vector<T, Policy>::operator=(const vector<T, Policy>& other) {
     //printf("copy assign called\n");
     if (this != &other) {
-        if (!empty()) {
-            clear();
-            operator delete (_data);
-            _capacity = 0;
-        }
-        copy(other);
+        // the old buffer goes only once the copy succeeded, and without passing
+        // through clear(), which could shrink it first under shrinking_policy
+        vector copied(other);
+        swap(copied);
     }
     return *this;
   }
 
   // O(1) strong
-  template <typename T>
-  vector<T>& vector<T>::operator=(vector<T>&& other) {
+  template <typename T, typename Policy>
+  vector<T, Policy>& vector<T, Policy>::operator=(vector<T, Policy>&& other) noexcept {
     // printf("move assign called\n");
     if (this != &other) {
-      clear();
-      operator delete(_data);
+      destroy(_data, _size);
+      deallocate(_data, _capacity);
 
       _data = other._data;
       _size = other._size;
@@ -212,260 +621,236 @@ vector<T>::vector(vector &&other) {
     return *this;
   }
 
-  template <typename T>
-  vector<T>::~vector() noexcept {
-    if (_size > 0) {
-      for (size_t i = _size; i > 0; i--) {
-        _data[i-1].~T();
-      }
-
-      operator delete(_data);
-    }
+  template <typename T, typename Policy>
+  vector<T, Policy>::~vector() noexcept {
+    destroy(_data, _size);
+    deallocate(_data, _capacity);
   }
 
 // O(1) nothrow
-template<typename T>
-T& vector<T>::operator[](size_t index) {
+template <typename T, typename Policy>
+T& vector<T, Policy>::operator[](size_t index) {
     //printf("operator[] called\n");
     return _data[index];
 }
 
 // O(1) nothrow
-template<typename T>
-const T& vector<T>::operator[](size_t index) const {
+template <typename T, typename Policy>
+const T& vector<T, Policy>::operator[](size_t index) const {
     //printf("const operator[] called\n");
     return _data[index];
 }
 
-template<typename T>
-T* vector<T>::data() noexcept {
+template <typename T, typename Policy>
+T* vector<T, Policy>::data() noexcept {
     return _data;
 }
 
-template<typename T>
-const T* vector<T>::data() const noexcept {
+template <typename T, typename Policy>
+const T* vector<T, Policy>::data() const noexcept {
     return _data;
 }
 
 
-template<typename T>
-size_t vector<T>::size() const noexcept {
+template <typename T, typename Policy>
+size_t vector<T, Policy>::size() const noexcept {
     return _size;
 }
 
 
 // O(1) nothrow
-template<typename T>
-T& vector<T>::front() {
+template <typename T, typename Policy>
+T& vector<T, Policy>::front() {
     return _data[0];
 }
 
 // O(1) nothrow
-template<typename T>
-const T& vector<T>::front() const {
+template <typename T, typename Policy>
+const T& vector<T, Policy>::front() const {
     return _data[0];
 }
 
 // O(1) nothrow
-template<typename T>
-T& vector<T>::back() {
+template <typename T, typename Policy>
+T& vector<T, Policy>::back() {
     return _data[_size-1];
 }
 
 // O(1) nothrow
-template<typename T>
-const T& vector<T>::back() const {
+template <typename T, typename Policy>
+const T& vector<T, Policy>::back() const {
     return _data[_size-1];
 }
 
-template<typename T>
-void vector<T>::push_back(const T& value) {
-    //printf("push_back\n");
-    size_t first_alloc_size = 2;
-    size_t new_capacity = 0;
-    if (_capacity == 0) {
-        new_capacity = first_alloc_size;
-    } else if (_capacity < _size + 1) {
-        new_capacity = _capacity*2;
-    }
-    if (new_capacity > 0) {
-        //printf("start reserve %lu...\n", new_capacity);
-        T* new_data = static_cast<T*>(operator new(new_capacity * sizeof(T)));
-        // T* new_data = static_cast<T*>(malloc(new_capacity * sizeof(T)));
-        if (_capacity > 0) {
-            size_t copied = 0;
-            try
-            {
-                for (size_t i = 0; i < _size; i++) {
-                    new (new_data + i) T(_data[i]);
-                    copied++;
-                }
-                
-                new (new_data + _size) T(value);
-                copied++;
-            }
-            catch(...)
-            {
-                if (copied > 0) {
-                    for (size_t i = 0; i < copied; i++) {
-                        new_data[i].~T();
-                    }
-                }
-                operator delete(new_data);
-                throw;
-            }
-
-            for (size_t i = 0; i < _size; i++) {
-                _data[i].~T();
-            }
-            operator delete(_data);
-            // free(_data);
+template <typename T, typename Policy>
+void vector<T, Policy>::push_back(const T& value) {
+  if (_size < _capacity) {
+    new (_data + _size) T(value);
+    ++_size;
+    return;
+  }
 
-            _size++;
-        } else {
-            new (new_data + _size) T(value);
-            _size++;
-        }
-        //printf("reserved %lu\n", new_capacity);
-        _capacity = new_capacity;
-        _data = new_data;
-    } else {
-        new (_data + _size) T(value);
-        _size++;
-    }
-    
-    // new (_data + _size) T(value);
-    // _size++;
-    
+  size_t new_capacity;
+  T* new_data = allocate_for_growth(_size + 1, new_capacity);
+  // value may be one of the elements, so it is copied before they move
+  try {
+    new (new_data + _size) T(value);
+  } catch (...) {
+    deallocate(new_data, new_capacity);
+    throw;
+  }
+  try {
+    replace_buffer(new_data, new_capacity);
+  } catch (...) {
+    new_data[_size].~T();
+    deallocate(new_data, new_capacity);
+    throw;
+  }
+  ++_size;
 }
 
-template<typename T>
-void vector<T>::pop_back() {
+template <typename T, typename Policy>
+void vector<T, Policy>::pop_back() {
     if (_size > 0)
     {
-        _data[_size-1].~T();
+        destroy(_data + _size - 1, 1);
         _size--;
+        shrink_after_erase();
     }
 }
 
-template<typename T>
-bool vector<T>::empty() const noexcept {
+template <typename T, typename Policy>
+bool vector<T, Policy>::empty() const noexcept {
     return _size == 0;
 }
 
 
-template<typename T>
-size_t vector<T>::capacity() const noexcept {
+template <typename T, typename Policy>
+size_t vector<T, Policy>::capacity() const noexcept {
     return _capacity;
 }
 
-template<typename T>
-void vector<T>::reserve(size_t new_capacity) {
+template <typename T, typename Policy>
+size_t vector<T, Policy>::max_size() const noexcept {
+    return max_elements;
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::reserve(size_t new_capacity) {
     // trying to reserve 0 or less than already reserved
     if (new_capacity <= _capacity)
     {
         return;
     }
     
-    //printf("start reserve %lu...\n", new_capacity);
-    T* new_data = static_cast<T*>(operator new(new_capacity * sizeof(T)));
-    if (_capacity > 0) {
-        size_t copied = 0;
-        try {
-            for (size_t i = 0; i < _size; i++) {
-                new (new_data + i) T(_data[i]);
-                copied++;
-            }
-        } catch (...) {
-            for (size_t i = 0; i < copied; i++) {
-                new_data[i].~T();
-            }
-            operator delete(new_data);
-            throw;
-        }
-        
-        for (size_t i = 0; i < _size; i++) {
-            _data[i].~T();
-        }
-
-        operator delete(_data);
+    T* new_data = allocate(new_capacity);
+    try {
+        replace_buffer(new_data, new_capacity);
+    } catch (...) {
+        deallocate(new_data, new_capacity);
+        throw;
     }
-    //printf("reserved %lu\n", new_capacity);
-    _capacity = new_capacity;
-    _data = new_data;
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::resize(size_t new_size) requires std::default_initializable<T> {
+  if (new_size <= _size) {
+    destroy(_data + new_size, _size - new_size);
+    _size = new_size;
+    shrink_after_erase();
+    return;
+  }
+  if (new_size > max_elements) {
+    throw std::length_error("vector: size exceeds max_size()");
+  }
+  reserve(new_size);
+  std::uninitialized_value_construct_n(_data + _size, new_size - _size);
+  _size = new_size;
 }
 
 // O(N) strong
-template<typename T>
-void vector<T>::shrink_to_fit() {
+template <typename T, typename Policy>
+void vector<T, Policy>::shrink_to_fit() {
     if (_capacity > _size) {
-        //printf("start reserve %lu...\n", new_capacity);
-        T* new_data = static_cast<T*>(operator new(_size * sizeof(T)));
-
-        size_t copied = 0;
+        T* new_data = allocate(_size);
         try {
-            for (size_t i = 0; i < _size; i++) {
-                new (new_data + i) T(_data[i]);
-                copied++;
-            }
+            replace_buffer(new_data, _size);
         } catch (...) {
-            for (size_t i = 0; i < copied; i++) {
-                new_data[i].~T();
-            }
-            operator delete(new_data);
+            deallocate(new_data, _size);
             throw;
         }
-        
-        for (size_t i = 0; i < _size; i++) {
-            _data[i].~T();
-        }
-
-        operator delete(_data);
-    
-        //printf("reserved %lu\n", new_capacity);
-        _capacity = _size;
-        _data = new_data;
     }
-    
 }
 
 // O(N) nothrow
-template <typename T>
-void vector<T>::clear() noexcept {
-    for (size_t i = 0; i < _size; i++)
-    {
-        _data[i].~T();
+template <typename T, typename Policy>
+void vector<T, Policy>::clear() noexcept {
+    destroy(_data, _size);
+    _size = 0;
+    if constexpr (auto_shrinking_policy<Policy>) {
+        if (_capacity * sizeof(T) > Policy::min_shrink_bytes) {
+            deallocate(_data, _capacity);
+            _data = nullptr;
+            _capacity = 0;
+        }
     }
+}
 
-    _size = 0;
+template <typename T, typename Policy>
+void vector<T, Policy>::swap(vector& other) noexcept {
+  std::swap(_data, other._data);
+  std::swap(_size, other._size);
+  std::swap(_capacity, other._capacity);
 }
 
-// O(1) nothrow
-//   void swap(vector& other) noexcept;
+template <typename T, typename Policy>
+void swap(vector<T, Policy>& lhs, vector<T, Policy>& rhs) noexcept {
+  lhs.swap(rhs);
+}
 
 // O(1) nothrow
-template <typename T>
-T* vector<T>::begin() noexcept {
+template <typename T, typename Policy>
+T* vector<T, Policy>::begin() noexcept {
     return _data;
 }
 
-template <typename T>
-T* vector<T>::end() noexcept {
+template <typename T, typename Policy>
+T* vector<T, Policy>::end() noexcept {
     return _data + _size;
 }
 
-template <typename T>
-const T* vector<T>::begin() const noexcept {
+template <typename T, typename Policy>
+const T* vector<T, Policy>::begin() const noexcept {
     return _data;
 }
 
-template <typename T>
-const T* vector<T>::end() const noexcept {
+template <typename T, typename Policy>
+const T* vector<T, Policy>::end() const noexcept {
     return _data + _size;
 }
 
-template <typename T>
-T* vector<T>::insert(const T* pos, const T& value) {
+template <typename T, typename Policy>
+vector_view<T> vector<T, Policy>::view() noexcept {
+  return vector_view<T>(_data, _size);
+}
+
+template <typename T, typename Policy>
+vector_view<const T> vector<T, Policy>::view() const noexcept {
+  return vector_view<const T>(_data, _size);
+}
+
+template <typename T, typename Policy>
+vector_view<T> vector<T, Policy>::view(size_t first, size_t count) {
+  return view().subview(first, count);
+}
+
+template <typename T, typename Policy>
+vector_view<const T> vector<T, Policy>::view(size_t first, size_t count) const {
+  return view().subview(first, count);
+}
+
+template <typename T, typename Policy>
+T* vector<T, Policy>::insert(const T* pos, const T& value) {
   if (empty()) {
     push_back(value);
     return begin();
@@ -474,48 +859,44 @@ T* vector<T>::insert(const T* pos, const T& value) {
   size_t idx = pos - _data;
 
   size_t new_capacity = 0;
+  T* new_data = nullptr;
   if (_capacity < _size + 1) {
-    new_capacity = _capacity * 2;
+    new_data = allocate_for_growth(_size + 1, new_capacity);
   }
 
-  if (new_capacity > 0) {
-
-    // reserve
-    
-    T* new_data = static_cast<T*>(operator new(new_capacity * sizeof(T)));
-
-    size_t copied = 0;
+  if (new_data != nullptr) {
     try {
-        for (size_t i = 0; i < idx; i++) {
-            new (new_data + i) T(_data[i]);
-            copied++;
-        }
-        new (new_data + idx) T(value);
-        copied++;
-        for (size_t i = _size; i > idx; i--) {
-            new (new_data + i) T(_data[i-1]);
-            copied++;
-        }
-
+      new (new_data + idx) T(value);
     } catch (...) {
-        for (size_t i = 0; i < copied; i++) {
-            new_data[i].~T();
-        }
-        operator delete(new_data);
-        throw;
+      deallocate(new_data, new_capacity);
+      throw;
     }
-    
-    for (size_t i = 0; i < _size; i++) {
-        _data[i].~T();
+    try {
+      relocate(_data, idx, new_data);
+      try {
+        relocate(_data + idx, _size - idx, new_data + idx + 1);
+      } catch (...) {
+        std::destroy_n(new_data, idx);
+        throw;
+      }
+    } catch (...) {
+      new_data[idx].~T();
+      deallocate(new_data, new_capacity);
+      throw;
     }
 
-    operator delete(_data);
-    
-    //printf("reserved %lu\n", new_capacity);
+    destroy_relocated(_data, _size);
+    deallocate(_data, _capacity);
     _capacity = new_capacity;
     _data = new_data;
 
-    // end reserve
+  } else if constexpr (trivially_relocatable<T>) {
+
+    // the copy is made before the shift, as value may be one of the elements
+    alignas(T) unsigned char copy[sizeof(T)];
+    new (copy) T(value);
+    std::memmove(static_cast<void*>(_data + idx + 1), static_cast<const void*>(_data + idx), (_size - idx) * sizeof(T));
+    std::memcpy(static_cast<void*>(_data + idx), copy, sizeof(T));
 
   } else {
 
@@ -535,8 +916,8 @@ T* vector<T>::insert(const T* pos, const T& value) {
   return _data + idx;
 }
 
-template <typename T>
-T* vector<T>::erase(const T* pos) {
+template <typename T, typename Policy>
+T* vector<T, Policy>::erase(const T* pos) {
     if (empty()) {
         return nullptr;
     }
@@ -546,15 +927,16 @@ T* vector<T>::erase(const T* pos) {
     for (size_t i = idx; i < _size - 1; i++) {
         _data[i] = _data[i+1];
     }
-    _data[_size-1].~T();
+    destroy(_data + _size - 1, 1);
 
     _size--;
+    shrink_after_erase();
 
     return _data + idx;
 }
 
-template <typename T>
-T* vector<T>::erase(const T* first, const T* last) {
+template <typename T, typename Policy>
+T* vector<T, Policy>::erase(const T* first, const T* last) {
     if (empty()) {
         return nullptr;
     }
@@ -594,12 +976,195 @@ T* vector<T>::erase(const T* first, const T* last) {
         _data[i] = _data[i + ec];
     }
 
-    for (size_t i = erase_to; i < _size; i++) {
-        _data[i].~T();
-    }
+    destroy(_data + erase_to, ec);
 
     _size -= ec;
+    shrink_after_erase();
 
     return _data + first_i;
 }
 
+template <typename T, typename Policy>
+void vector<T, Policy>::shrink_after_erase() noexcept {
+  if constexpr (auto_shrinking_policy<Policy>) {
+    if (_size >= _capacity / 4 || _capacity * sizeof(T) <= Policy::min_shrink_bytes) {
+      return;
+    }
+
+    size_t new_capacity = std::max({size_t(2) * _size, Policy::min_shrink_bytes / sizeof(T), size_t(1)});
+    T* new_data;
+    try {
+      new_data = allocate_at_least(new_capacity);
+    } catch (...) {
+      return;
+    }
+
+    try {
+      replace_buffer(new_data, new_capacity);
+    } catch (...) {
+      deallocate(new_data, new_capacity);
+    }
+  }
+}
+
+template <typename T, typename Policy>
+void vector<T, Policy>::grow_for_append(size_t count) requires byte_like<T> {
+    if (_capacity - _size >= count) {
+        return;
+    }
+    if (count > max_elements - _size) {
+        throw std::length_error("vector: size exceeds max_size()");
+    }
+    size_t new_capacity;
+    T* new_data = allocate_for_growth(_size + count, new_capacity);
+    if (_size > 0) {
+        std::memcpy(new_data, _data, _size);
+    }
+    deallocate(_data, _capacity);
+    _data = new_data;
+    _capacity = new_capacity;
+}
+
+template <typename T, typename Policy>
+size_t vector<T, Policy>::read_size(size_t max) const noexcept requires byte_like<T> {
+    size_t spare = _capacity - _size;
+    return std::min(max, std::max({spare, min_read_growth, size_t(_size)}));
+}
+
+#ifdef VECTOR_HAVE_POSIX_IO
+
+template <typename T, typename Policy>
+size_t vector<T, Policy>::append_from_fd(int fd, size_t max) requires byte_like<T> {
+    max = read_size(max);
+    grow_for_append(max);
+    ssize_t n;
+    do {
+        n = ::read(fd, _data + _size, max);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw std::system_error(errno, std::generic_category(), "read");
+    }
+    _size += n;
+    return n;
+}
+
+template <typename T, typename Policy>
+size_t vector<T, Policy>::append_from_fd(int fd, size_t max, off_t offset) requires byte_like<T> {
+    max = read_size(max);
+    grow_for_append(max);
+    ssize_t n;
+    do {
+        n = ::pread(fd, _data + _size, max, offset);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw std::system_error(errno, std::generic_category(), "pread");
+    }
+    _size += n;
+    return n;
+}
+
+template <typename T, typename Policy>
+size_t vector<T, Policy>::read_all(int fd) requires byte_like<T> {
+    static constexpr size_t min_chunk = 4096;
+
+    size_t old_size = _size;
+    // the original buffer once the read outgrew it, put back on failure
+    vector original;
+    auto grow = [&](size_t count) {
+        if (_capacity - _size >= count || original._data != nullptr || _data == nullptr) {
+            grow_for_append(count);
+            return;
+        }
+        vector grown;
+        grown.grow_for_append(_size + count);
+        std::memcpy(grown._data, _data, _size);
+        grown._size = _size;
+        swap(grown);
+        original.swap(grown);
+    };
+
+    try {
+        // regular files announce their size, so most of them are read in a single call
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            off_t pos = ::lseek(fd, 0, SEEK_CUR);
+            if (pos >= 0 && st.st_size > pos) {
+                grow(st.st_size - pos);
+            }
+        }
+
+        for (;;) {
+            if (_size < _capacity) {
+                if (append_from_fd(fd, _capacity - _size) == 0) {
+                    break;
+                }
+                continue;
+            }
+            // the buffer is full: probe for end of file before paying for a reallocation
+            char probe[min_chunk];
+            ssize_t n;
+            do {
+                n = ::read(fd, probe, sizeof(probe));
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) {
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if (n == 0) {
+                break;
+            }
+            grow(std::max<size_t>(min_chunk, _size));
+            std::memcpy(_data + _size, probe, n);
+            _size += n;
+        }
+    } catch (...) {
+        if (original._data != nullptr) {
+            swap(original);
+        }
+        _size = old_size;
+        throw;
+    }
+    return _size - old_size;
+}
+
+#endif
+
+template <typename T, typename P1, typename P2>
+  requires std::equality_comparable<T>
+bool operator==(const vector<T, P1>& lhs, const vector<T, P2>& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  if constexpr (trivially_comparable<T>) {
+    return lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0;
+  } else {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+}
+
+template <typename T, typename P1, typename P2>
+  requires std::three_way_comparable<T>
+std::compare_three_way_result_t<T> operator<=>(const vector<T, P1>& lhs, const vector<T, P2>& rhs) {
+  if constexpr (std::is_same_v<T, unsigned char> || std::is_same_v<T, std::byte>) {
+    // memcmp orders bytes as unsigned char
+    size_t common = std::min(lhs.size(), rhs.size());
+    int order = common == 0 ? 0 : std::memcmp(lhs.data(), rhs.data(), common);
+    return order != 0 ? order <=> 0 : lhs.size() <=> rhs.size();
+  } else {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+}
+
+template <typename T, typename Policy>
+  requires trivially_comparable<T> || requires(const T& value) { std::hash<T>()(value); }
+size_t std::hash<vector<T, Policy>>::operator()(const ::vector<T, Policy>& a) const
+    noexcept(trivially_comparable<T>) {
+  if constexpr (trivially_comparable<T>) {
+    return bulk_hash(a.data(), a.size() * sizeof(T));
+  } else {
+    uint64_t h = a.size();
+    for (const T& value : a) {
+      h = bulk_hash_detail::fold(h ^ bulk_hash_detail::secret[0], std::hash<T>()(value) ^ bulk_hash_detail::secret[1]);
+    }
+    return bulk_hash_detail::avalanche(h);
+  }
+}
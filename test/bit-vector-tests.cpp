@@ -0,0 +1,109 @@
+#include "bit-vector.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(bit_vector_test, push_back_and_index) {
+  static constexpr size_t N = 1000;
+
+  bit_vector a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(i % 3 == 0);
+  }
+
+  EXPECT_EQ(N, a.size());
+  EXPECT_EQ((N + 63) / 64, a.word_count());
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(i % 3 == 0, a[i]);
+  }
+
+  a[1] = true;
+  a[0].flip();
+  EXPECT_TRUE(a.test(1));
+  EXPECT_FALSE(a.test(0));
+
+  const bit_vector& ca = a;
+  EXPECT_TRUE(ca[1]);
+}
+
+TEST(bit_vector_test, pop_back_keeps_tail_clear) {
+  bit_vector a(130, true);
+  EXPECT_EQ(130, a.count());
+
+  a.pop_back();
+  a.pop_back();
+  EXPECT_EQ(128, a.size());
+  EXPECT_EQ(2, a.word_count());
+  EXPECT_EQ(128, a.count());
+
+  a.push_back(false);
+  EXPECT_EQ(128, a.count());
+  EXPECT_EQ(0, a.words()[2]);
+
+  // popping an empty vector leaves it empty
+  bit_vector b;
+  b.pop_back();
+  EXPECT_EQ(0, b.size());
+  EXPECT_EQ(0, b.word_count());
+  b.push_back(true);
+  EXPECT_EQ(1, b.count());
+}
+
+TEST(bit_vector_test, count_and_find) {
+  static constexpr size_t N = 10'000;
+
+  bit_vector a(N);
+  EXPECT_EQ(0, a.count());
+  EXPECT_EQ(bit_vector::npos, a.find_first());
+
+  std::vector<size_t> expected = {3, 64, 65, 700, 4095, 4096, N - 1};
+  for (size_t i : expected) {
+    a.set(i);
+  }
+  EXPECT_EQ(expected.size(), a.count());
+
+  std::vector<size_t> found;
+  for (size_t i = a.find_first(); i != bit_vector::npos; i = a.find_next(i)) {
+    found.push_back(i);
+  }
+  EXPECT_EQ(expected, found);
+  EXPECT_EQ(bit_vector::npos, a.find_next(bit_vector::npos));
+}
+
+TEST(bit_vector_test, bulk_operations) {
+  static constexpr size_t N = 300;
+
+  bit_vector a(N), b(N);
+  for (size_t i = 0; i < N; ++i) {
+    a[i] = i % 2 == 0;
+    b[i] = i % 3 == 0;
+  }
+
+  bit_vector c = a & b;
+  bit_vector d = a | b;
+  bit_vector e = a ^ b;
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(i % 6 == 0, c[i]);
+    ASSERT_EQ(i % 2 == 0 || i % 3 == 0, d[i]);
+    ASSERT_EQ((i % 2 == 0) != (i % 3 == 0), e[i]);
+  }
+
+  a ^= a;
+  EXPECT_EQ(bit_vector(N), a);
+
+  EXPECT_THROW(a &= bit_vector(N + 1), std::invalid_argument);
+}
+
+TEST(bit_vector_test, copy_and_move) {
+  bit_vector a(100, true);
+  bit_vector b = a;
+  EXPECT_EQ(a, b);
+
+  bit_vector c = std::move(a);
+  EXPECT_EQ(b, c);
+  EXPECT_TRUE(a.empty());
+
+  a = c;
+  EXPECT_EQ(c, a);
+}
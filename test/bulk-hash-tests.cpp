@@ -0,0 +1,64 @@
+#include "bulk-hash.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+std::vector<unsigned char> random_bytes(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<unsigned char> result(count);
+  for (unsigned char& c : result) {
+    c = static_cast<unsigned char>(rng());
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(bulk_hash_test, every_length_and_bit) {
+  // flipping any single bit changes the hash, for every length class
+  std::vector<unsigned char> bytes = random_bytes(300, 1);
+  for (size_t length = 1; length <= bytes.size(); length += length < 20 ? 1 : 7) {
+    uint64_t original = bulk_hash(bytes.data(), length);
+    std::unordered_set<uint64_t> seen{original};
+    for (size_t bit = 0; bit < length * 8; ++bit) {
+      bytes[bit / 8] ^= static_cast<unsigned char>(1 << bit % 8);
+      seen.insert(bulk_hash(bytes.data(), length));
+      bytes[bit / 8] ^= static_cast<unsigned char>(1 << bit % 8);
+    }
+    EXPECT_EQ(length * 8 + 1, seen.size()) << "length " << length;
+    EXPECT_EQ(original, bulk_hash(bytes.data(), length));
+  }
+}
+
+TEST(bulk_hash_test, length_seed_and_alignment) {
+  std::vector<unsigned char> zeros(200, 0);
+  std::unordered_set<uint64_t> seen;
+  for (size_t length = 0; length <= zeros.size(); ++length) {
+    seen.insert(bulk_hash(zeros.data(), length));
+  }
+  EXPECT_EQ(zeros.size() + 1, seen.size());
+
+  std::vector<unsigned char> bytes = random_bytes(200, 2);
+  EXPECT_NE(bulk_hash(bytes.data(), bytes.size(), 1), bulk_hash(bytes.data(), bytes.size(), 2));
+
+  // the value depends on the contents only, not on where they are
+  std::vector<unsigned char> shifted(1);
+  shifted.insert(shifted.end(), bytes.begin(), bytes.end());
+  EXPECT_EQ(bulk_hash(bytes.data(), bytes.size()), bulk_hash(shifted.data() + 1, bytes.size()));
+}
+
+TEST(bulk_hash_test, no_collisions_on_small_keys) {
+  // consecutive integers are the worst case for weak mixing
+  std::unordered_set<uint64_t> seen;
+  for (uint32_t i = 0; i < 200'000; ++i) {
+    uint32_t key[3] = {i, i * 7, 0};
+    seen.insert(bulk_hash(key, sizeof(key)));
+  }
+  EXPECT_EQ(200'000, seen.size());
+}
@@ -0,0 +1,103 @@
+#include "deferred-release.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+// records the threads its instances are destroyed on
+struct tracked {
+  tracked() = default;
+
+  tracked(const tracked&) {}
+
+  ~tracked() {
+    ++destroyed;
+    if (std::this_thread::get_id() != owner) {
+      ++destroyed_elsewhere;
+    }
+  }
+
+  inline static std::thread::id owner;
+  inline static std::atomic<size_t> destroyed{0};
+  inline static std::atomic<size_t> destroyed_elsewhere{0};
+};
+
+vector<std::string> make_strings(size_t count) {
+  vector<std::string> result;
+  result.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    result.push_back("a string too long for the small string buffer " + std::to_string(i));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(deferred_release_test, destroys_on_reclaimer_thread) {
+  tracked::owner = std::this_thread::get_id();
+  tracked::destroyed = 0;
+  tracked::destroyed_elsewhere = 0;
+
+  vector<tracked> a;
+  for (int i = 0; i < 1000; ++i) {
+    a.push_back(tracked());
+  }
+  size_t temporaries = tracked::destroyed;
+  deferred_release(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(0, a.capacity());
+
+  background_reclaimer::global().flush();
+  EXPECT_EQ(0, background_reclaimer::global().pending());
+  EXPECT_EQ(temporaries + 1000, tracked::destroyed);
+  EXPECT_EQ(1000, tracked::destroyed_elsewhere);
+}
+
+TEST(deferred_release_test, empty_vector_stays_local) {
+  vector<std::string> a;
+  deferred_release(a);
+  EXPECT_EQ(0, background_reclaimer::global().pending());
+}
+
+TEST(deferred_release_test, many_threads) {
+  background_reclaimer reclaimer;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 1000; ++i) {
+        reclaimer.release(make_strings(10));
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  reclaimer.flush();
+  EXPECT_EQ(0, reclaimer.pending());
+}
+
+TEST(deferred_release_performance_test, teardown_latency) {
+  constexpr size_t n = 2'000'000;
+
+  vector<std::string> inline_strings = make_strings(n);
+  auto start = std::chrono::steady_clock::now();
+  inline_strings = vector<std::string>();
+  auto inline_elapsed = std::chrono::steady_clock::now() - start;
+
+  vector<std::string> deferred_strings = make_strings(n);
+  start = std::chrono::steady_clock::now();
+  deferred_release(deferred_strings);
+  auto deferred_elapsed = std::chrono::steady_clock::now() - start;
+  background_reclaimer::global().flush();
+
+  auto us = [](auto d) { return std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(d).count()); };
+  RecordProperty("inline_teardown_microseconds", us(inline_elapsed));
+  RecordProperty("deferred_teardown_microseconds", us(deferred_elapsed));
+  EXPECT_LT(deferred_elapsed, inline_elapsed);
+}
@@ -109,30 +109,45 @@ void fault_injection_point() {
   }
 }
 
-void faulty_run(const std::function<void()>& f) {
+namespace {
+
+void run_faulty(const std::function<void()>& f, bool allow_recovery) {
   assert(!context);
   fault_injection_context ctx;
   context = &ctx;
   for (;;) {
+    bool failed = false;
     try {
       f();
     } catch (...) {
-      fault_injection_disable dg;
-      dump_state();
-      ctx.skip_ranges.resize(ctx.error_index);
-      ++ctx.skip_ranges.back();
-      ctx.error_index = 0;
-      ctx.skip_index = 0;
-      assert(ctx.fault_registered);
-      ctx.fault_registered = false;
-      continue;
+      failed = true;
     }
-    assert(!ctx.fault_registered);
-    break;
+    if (!failed && !(allow_recovery && ctx.fault_registered)) {
+      break;
+    }
+    fault_injection_disable dg;
+    dump_state();
+    ctx.skip_ranges.resize(ctx.error_index);
+    ++ctx.skip_ranges.back();
+    ctx.error_index = 0;
+    ctx.skip_index = 0;
+    assert(ctx.fault_registered);
+    ctx.fault_registered = false;
   }
+  assert(!ctx.fault_registered);
   context = nullptr;
 }
 
+} // namespace
+
+void faulty_run(const std::function<void()>& f) {
+  run_faulty(f, false);
+}
+
+void faulty_run_allowing_recovery(const std::function<void()>& f) {
+  run_faulty(f, true);
+}
+
 fault_injection_disable::fault_injection_disable()
     : was_disabled(disabled) {
   disabled = true;
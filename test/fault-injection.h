@@ -11,6 +11,10 @@ bool should_inject_fault();
 void fault_injection_point();
 void faulty_run(const std::function<void()>& f);
 
+// Same as faulty_run(), but f may also recover from an injected fault and
+// return normally, as code retrying a failed allocation with less does.
+void faulty_run_allowing_recovery(const std::function<void()>& f);
+
 struct fault_injection_disable {
   fault_injection_disable();
 
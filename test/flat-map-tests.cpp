@@ -0,0 +1,169 @@
+#include "flat-map.h"
+#include "flat-set.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+TEST(flat_set_test, insert_and_find) {
+  flat_set<int> a;
+  EXPECT_TRUE(a.insert(5).second);
+  EXPECT_TRUE(a.insert(1).second);
+  EXPECT_TRUE(a.insert(3).second);
+  EXPECT_FALSE(a.insert(3).second);
+
+  EXPECT_EQ(3, a.size());
+  EXPECT_TRUE(a.contains(1));
+  EXPECT_FALSE(a.contains(2));
+  EXPECT_EQ(a.end(), a.find(4));
+  EXPECT_EQ(3, *a.lower_bound(2));
+  EXPECT_EQ(5, *a.upper_bound(3));
+  EXPECT_TRUE(std::is_sorted(a.begin(), a.end()));
+
+  EXPECT_EQ(1, a.erase(3));
+  EXPECT_EQ(0, a.erase(3));
+  EXPECT_EQ(2, a.size());
+}
+
+TEST(flat_set_test, bulk_insert) {
+  static constexpr size_t N = 10'000;
+
+  std::mt19937 rng(1);
+  std::set<int> expected;
+  flat_set<int> a;
+  for (size_t round = 0; round < 5; ++round) {
+    std::vector<int> batch;
+    for (size_t i = 0; i < N; ++i) {
+      batch.push_back(rng() % (3 * N));
+    }
+    expected.insert(batch.begin(), batch.end());
+    a.insert(batch.begin(), batch.end());
+
+    ASSERT_EQ(expected.size(), a.size());
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), a.begin(), a.end()));
+  }
+}
+
+TEST(flat_set_test, first_of_equivalent_wins) {
+  static constexpr int N = 1000;
+
+  auto by_key = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) { return lhs.first < rhs.first; };
+  std::vector<std::pair<int, int>> batch;
+  for (int i = 0; i < N; ++i) {
+    batch.push_back({(N - i) % 10, i});
+  }
+  flat_set<std::pair<int, int>, decltype(by_key)> a(batch.begin(), batch.end());
+
+  ASSERT_EQ(10, a.size());
+  for (const std::pair<int, int>& x : a) {
+    EXPECT_EQ((N - x.first) % 10, x.second);
+  }
+}
+
+TEST(flat_set_test, sorted_unique_insert) {
+  std::vector<int> evens, odds;
+  for (int i = 0; i < 100; ++i) {
+    (i % 2 == 0 ? evens : odds).push_back(i);
+  }
+
+  flat_set<int> a(sorted_unique, evens.begin(), evens.end());
+  a.insert(sorted_unique, odds.begin(), odds.end());
+  a.insert(sorted_unique, evens.begin(), evens.end());
+
+  ASSERT_EQ(100, a.size());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(i, a.sequence()[i]);
+  }
+}
+
+TEST(flat_set_test, custom_compare) {
+  std::vector<std::string> words = {"b", "a", "c", "a"};
+  flat_set<std::string, std::greater<>> a(words.begin(), words.end());
+  ASSERT_EQ(3, a.size());
+  EXPECT_EQ("c", *a.begin());
+}
+
+TEST(flat_map_test, insert_and_lookup) {
+  flat_map<int, std::string> a;
+  EXPECT_TRUE(a.insert(2, "two").second);
+  EXPECT_TRUE(a.insert(1, "one").second);
+  EXPECT_FALSE(a.insert(2, "deux").second);
+
+  EXPECT_EQ("two", a.at(2));
+  EXPECT_THROW(a.at(3), std::out_of_range);
+  EXPECT_EQ("", a[3]);
+  a[3] = "three";
+  EXPECT_EQ("three", std::as_const(a).at(3));
+
+  auto it = a.find(1);
+  ASSERT_NE(a.end(), it);
+  flat_map<int, std::string>::const_iterator cit = it;
+  EXPECT_EQ(1, cit.key());
+  EXPECT_EQ(1, (*it).first);
+  EXPECT_EQ("one", (*it).second);
+  (*it).second = "uno";
+  EXPECT_EQ("uno", a.at(1));
+
+  EXPECT_EQ(1, a.erase(1));
+  EXPECT_FALSE(a.contains(1));
+  EXPECT_EQ(2, a.size());
+  EXPECT_EQ(2, a.keys()[0]);
+  EXPECT_EQ("two", a.values()[0]);
+
+  // keys whose assignment may throw take the other erase path
+  flat_map<std::string, int> b;
+  for (int i = 0; i < 10; ++i) {
+    b.insert(std::to_string(i), i);
+  }
+  EXPECT_EQ(1, b.erase("3"));
+  EXPECT_EQ(0, b.erase("3"));
+  ASSERT_EQ(9, b.size());
+  for (size_t i = 0; i < b.size(); ++i) {
+    EXPECT_EQ(b.keys()[i], std::to_string(b.values()[i]));
+  }
+}
+
+TEST(flat_map_test, bulk_insert) {
+  static constexpr size_t N = 10'000;
+
+  std::mt19937 rng(2);
+  std::map<int, int> expected;
+  flat_map<int, int> a;
+  for (size_t round = 0; round < 5; ++round) {
+    std::vector<std::pair<int, int>> batch;
+    for (size_t i = 0; i < N; ++i) {
+      batch.emplace_back(rng() % (3 * N), static_cast<int>(round * N + i));
+    }
+    expected.insert(batch.begin(), batch.end());
+    a.insert(batch.begin(), batch.end());
+
+    ASSERT_EQ(expected.size(), a.size());
+    size_t i = 0;
+    for (auto [key, value] : expected) {
+      ASSERT_EQ(key, a.keys()[i]);
+      ASSERT_EQ(value, a.values()[i]);
+      ++i;
+    }
+  }
+
+  size_t visited = 0;
+  for (auto [key, value] : std::as_const(a)) {
+    ASSERT_EQ(expected.at(key), value);
+    ++visited;
+  }
+  EXPECT_EQ(expected.size(), visited);
+}
+
+TEST(flat_map_test, sorted_unique_insert) {
+  std::vector<std::pair<int, char>> items = {{1, 'a'}, {3, 'c'}, {5, 'e'}};
+  flat_map<int, char> a;
+  a.insert(sorted_unique, items.begin(), items.end());
+  a.insert(2, 'b');
+
+  ASSERT_EQ(4, a.size());
+  EXPECT_EQ('b', a.at(2));
+  EXPECT_EQ('e', a.at(5));
+}
@@ -0,0 +1,156 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "gap-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename T>
+std::vector<int> to_ints(const gap_vector<T>& a) {
+  fault_injection_disable dg;
+  std::vector<int> result;
+  for (const T& x : a) {
+    result.push_back(static_cast<int>(x));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(gap_vector_test, insert_erase_at_cursor) {
+  element::no_new_instances_guard guard;
+
+  std::mt19937 rng(3);
+  std::vector<int> expected;
+  gap_vector<element> a;
+  size_t cursor = 0;
+  for (int i = 0; i < 2000; ++i) {
+    cursor = std::min<size_t>(expected.size(), cursor + rng() % 3);
+    if (rng() % 4 == 0 && cursor < expected.size()) {
+      expected.erase(expected.begin() + cursor);
+      a.erase(cursor);
+    } else {
+      expected.insert(expected.begin() + cursor, i);
+      a.insert(cursor, i);
+    }
+    if (rng() % 50 == 0) {
+      cursor = rng() % (expected.size() + 1);
+    }
+  }
+
+  ASSERT_EQ(expected.size(), a.size());
+  EXPECT_EQ(expected, to_ints(a));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i], a[i]);
+  }
+}
+
+TEST(gap_vector_test, segments) {
+  gap_vector<int> a;
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(i);
+  }
+  a.insert(4, 100);
+
+  EXPECT_EQ(5, a.gap_position());
+  ASSERT_EQ(5, a.first_segment().size());
+  ASSERT_EQ(6, a.second_segment().size());
+  EXPECT_EQ(100, a.first_segment().back());
+  EXPECT_EQ(4, a.second_segment().front());
+
+  a.erase(2, 3);
+  EXPECT_EQ((std::vector<int>{0, 1, 4, 5, 6, 7, 8, 9}), to_ints(a));
+}
+
+TEST(gap_vector_test, insert_from_self) {
+  gap_vector<std::string> a;
+  a.push_back("a");
+  for (int i = 0; i < 100; ++i) {
+    a.insert(0, a[a.size() - 1]);
+  }
+  for (const std::string& s : a) {
+    ASSERT_EQ("a", s);
+  }
+}
+
+TEST(gap_vector_test, copy_and_move) {
+  element::no_new_instances_guard guard;
+
+  gap_vector<element> a;
+  for (int i = 0; i < 100; ++i) {
+    a.insert(i / 2, i);
+  }
+  gap_vector<element> b = a;
+  EXPECT_EQ(to_ints(a), to_ints(b));
+
+  gap_vector<element> c = std::move(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(to_ints(b), to_ints(c));
+
+  a = c;
+  EXPECT_EQ(to_ints(c), to_ints(a));
+}
+
+TEST(gap_vector_test, insert_throw) {
+  element::no_new_instances_guard guard;
+
+  faulty_run([] {
+    fault_injection_disable dg;
+    gap_vector<element> a;
+    for (int i = 0; i < 10; ++i) {
+      a.push_back(i);
+    }
+    std::vector<int> expected = to_ints(a);
+    dg.reset();
+
+    auto check = [&](auto op) {
+      try {
+        op();
+      } catch (...) {
+        fault_injection_disable dg2;
+        EXPECT_EQ(expected, to_ints(a));
+        throw;
+      }
+      expected = to_ints(a);
+    };
+    check([&] { a.insert(2, 42); });
+    check([&] { a.insert(8, 43); });
+    check([&] { a.erase(1); });
+    check([&] { a.insert(0, a[5]); });
+  });
+}
+
+TEST(gap_vector_performance_test, insert_near_cursor) {
+  static constexpr size_t N = 200'000;
+
+  gap_vector<int> a;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < N; ++i) {
+    a.insert(std::min(a.size(), a.size() / 2 + i % 8), static_cast<int>(i));
+  }
+  auto gap_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ASSERT_EQ(N, a.size());
+
+  static constexpr size_t M = 20'000;
+  vector<int> b;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < M; ++i) {
+    b.insert(b.begin() + std::min(b.size(), b.size() / 2 + i % 8), static_cast<int>(i));
+  }
+  auto vector_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // vector shifts half of itself on every insert, the gap only a few elements
+  double gap_rate = N / gap_elapsed;
+  double vector_rate = M / vector_elapsed;
+  EXPECT_GT(gap_rate, 2 * vector_rate);
+
+  RecordProperty("gap_vector_inserts_per_second", std::to_string(static_cast<uint64_t>(gap_rate)));
+  RecordProperty("vector_inserts_per_second", std::to_string(static_cast<uint64_t>(vector_rate)));
+}
@@ -0,0 +1,106 @@
+#include "packed-int-vector.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+
+TEST(packed_int_vector_test, random_access) {
+  static constexpr size_t N = 10'000;
+
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> expected;
+  packed_int_vector a;
+  uint64_t value = 1'700'000'000'000;
+  for (size_t i = 0; i < N; ++i) {
+    value += rng() % 1000;
+    if (i % 97 == 0) {
+      value -= 5000;
+    }
+    expected.push_back(value);
+    a.push_back(value);
+  }
+
+  ASSERT_EQ(N, a.size());
+  EXPECT_EQ(expected.back(), a.back());
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(expected[i], a[i]);
+  }
+
+  size_t i = 0;
+  for (uint64_t x : a) {
+    ASSERT_EQ(expected[i++], x);
+  }
+  EXPECT_EQ(N, i);
+}
+
+TEST(packed_int_vector_test, extreme_deltas) {
+  packed_int_vector a;
+  std::vector<uint64_t> expected = {0, UINT64_MAX, 0, 1, UINT64_MAX - 1, 42, 0x8000000000000000};
+  for (uint64_t x : expected) {
+    a.push_back(x);
+  }
+
+  vector<uint64_t> b = a.to_vector();
+  ASSERT_EQ(expected.size(), b.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], a[i]);
+    EXPECT_EQ(expected[i], b[i]);
+  }
+}
+
+TEST(packed_int_vector_test, copy_move_clear) {
+  packed_int_vector a;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    a.push_back(i * i);
+  }
+
+  packed_int_vector b = a;
+  packed_int_vector c = std::move(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(1000, c.size());
+  for (uint64_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(i * i, b[i]);
+    ASSERT_EQ(i * i, c[i]);
+  }
+
+  c.clear();
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(c.begin(), c.end());
+}
+
+TEST(packed_int_vector_performance_test, posting_list) {
+  static constexpr size_t N = 4'000'000;
+
+  std::mt19937_64 rng(7);
+  vector<uint64_t> plain;
+  packed_int_vector packed;
+  uint64_t doc = 0;
+  for (size_t i = 0; i < N; ++i) {
+    doc += 1 + rng() % 64;
+    plain.push_back(doc);
+    packed.push_back(doc);
+  }
+  plain.shrink_to_fit();
+  packed.shrink_to_fit();
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t sum = 0;
+  for (uint64_t x : packed) {
+    sum += x;
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  uint64_t expected_sum = 0;
+  for (size_t i = 0; i < N; ++i) {
+    expected_sum += plain[i];
+  }
+  EXPECT_EQ(expected_sum, sum);
+
+  size_t plain_bytes = plain.capacity() * sizeof(uint64_t);
+  EXPECT_LT(packed.memory_usage() * 4, plain_bytes);
+
+  RecordProperty("plain_bytes", std::to_string(plain_bytes));
+  RecordProperty("packed_bytes", std::to_string(packed.memory_usage()));
+  RecordProperty("decode_values_per_second", std::to_string(static_cast<uint64_t>(N / elapsed)));
+}
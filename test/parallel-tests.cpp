@@ -0,0 +1,289 @@
+#include "parallel.h"
+#include "thread-pool.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+vector<uint32_t> random_keys(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  vector<uint32_t> result;
+  result.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    result.push_back(rng());
+  }
+  return result;
+}
+
+template <typename T>
+std::vector<T> to_std(const vector<T>& a) {
+  return std::vector<T>(a.begin(), a.end());
+}
+
+// Sort key that counts how often it is copied.
+struct copy_counted {
+  static inline std::atomic<size_t> copies = 0;
+
+  uint32_t key;
+
+  explicit copy_counted(uint32_t key) noexcept
+      : key(key) {}
+  copy_counted(const copy_counted& other) noexcept
+      : key(other.key) {
+    ++copies;
+  }
+  copy_counted(copy_counted&&) noexcept = default;
+  copy_counted& operator=(const copy_counted& other) noexcept {
+    key = other.key;
+    ++copies;
+    return *this;
+  }
+  copy_counted& operator=(copy_counted&&) noexcept = default;
+
+  bool operator<(const copy_counted& other) const noexcept {
+    return key < other.key;
+  }
+};
+
+} // namespace
+
+TEST(parallel_test, task_group_nested) {
+  thread_pool pool(3);
+  std::atomic<size_t> count = 0;
+
+  task_group outer(pool);
+  for (int i = 0; i < 8; ++i) {
+    outer.run([&] {
+      task_group inner(pool);
+      for (int j = 0; j < 8; ++j) {
+        inner.run([&] { ++count; });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  EXPECT_EQ(64, count);
+}
+
+TEST(parallel_test, task_group_exception) {
+  thread_pool pool(2);
+  task_group group(pool);
+  for (int i = 0; i < 100; ++i) {
+    group.run([i] {
+      if (i == 42) {
+        throw std::runtime_error("task");
+      }
+    });
+  }
+  EXPECT_THROW(group.wait(), std::runtime_error);
+
+  // the group and the pool stay usable
+  std::atomic<int> count = 0;
+  group.run([&] { ++count; });
+  group.wait();
+  EXPECT_EQ(1, count);
+}
+
+TEST(parallel_test, task_group_destroys_tasks_before_wait_returns) {
+  thread_pool pool(3);
+  std::atomic<size_t> alive = 0;
+  struct state {
+    std::atomic<size_t>* alive;
+    explicit state(std::atomic<size_t>& alive) : alive(&alive) {
+      ++alive;
+    }
+    state(const state& other) : alive(other.alive) {
+      ++*alive;
+    }
+    ~state() {
+      // widens the window in which wait() could return too early
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      --*alive;
+    }
+  };
+
+  for (int round = 0; round < 4; ++round) {
+    task_group group(pool);
+    for (int i = 0; i < 8; ++i) {
+      group.run([s = state(alive)] { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+    }
+    group.wait();
+    ASSERT_EQ(0, alive) << round;
+  }
+}
+
+TEST(parallel_test, task_group_wait_sleeps) {
+  thread_pool pool(1);
+  task_group group(pool);
+  group.run([] { std::this_thread::sleep_for(std::chrono::milliseconds(400)); });
+  // let the worker take the task, so there is nothing left for the waiter to run
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  std::clock_t cpu = std::clock();
+  group.wait();
+  double seconds = static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC;
+  // clock() counts the whole process, which must be mostly idle meanwhile
+  EXPECT_GT(0.1, seconds);
+}
+
+TEST(parallel_test, chunk_bounds_on_cache_lines) {
+  vector<uint32_t> a = random_keys(1'000'000, 1);
+  for (size_t offset : {0, 1, 5}) {
+    const uint32_t* data = a.data() + offset;
+    vector<size_t> bounds = parallel_detail::chunk_bounds(data, a.size() - offset, 16);
+    ASSERT_EQ(17, bounds.size());
+    EXPECT_EQ(0, bounds[0]);
+    EXPECT_EQ(a.size() - offset, bounds[bounds.size() - 1]);
+    for (size_t i = 1; i + 1 < bounds.size(); ++i) {
+      EXPECT_LT(bounds[i - 1], bounds[i]);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data + bounds[i]) % parallel_cache_line);
+    }
+  }
+
+  // small ranges are not split
+  EXPECT_EQ(2, parallel_detail::chunk_bounds(a.data(), 1000, 16).size());
+}
+
+TEST(parallel_test, sort) {
+  thread_pool pool(3);
+  for (size_t count : {0, 1, 1000, 50'000, 1'000'000}) {
+    vector<uint32_t> a = random_keys(count, static_cast<uint32_t>(count));
+    std::vector<uint32_t> expected = to_std(a);
+    std::sort(expected.begin(), expected.end());
+
+    parallel_sort(a, std::less<>(), pool);
+    ASSERT_EQ(expected, to_std(a)) << count;
+  }
+
+  vector<uint32_t> a = random_keys(300'000, 7);
+  parallel_sort(a, std::greater<>(), pool);
+  EXPECT_TRUE(std::is_sorted(a.begin(), a.end(), std::greater<>()));
+}
+
+TEST(parallel_test, sort_strings) {
+  thread_pool pool(2);
+  std::mt19937 rng(3);
+  vector<std::string> a;
+  for (int i = 0; i < 20'000; ++i) {
+    a.push_back(std::to_string(rng() % 1000) + "-" + std::to_string(i));
+  }
+  std::vector<std::string> expected = to_std(a);
+  std::sort(expected.begin(), expected.end());
+
+  parallel_sort(a, std::less<>(), pool);
+  EXPECT_EQ(expected, to_std(a));
+}
+
+TEST(parallel_test, sort_does_not_copy) {
+  thread_pool pool(3);
+  vector<uint32_t> keys = random_keys(200'000, 5);
+  vector<copy_counted> a;
+  a.reserve(keys.size());
+  for (uint32_t key : keys) {
+    a.push_back(copy_counted(key));
+  }
+  copy_counted::copies = 0;
+
+  parallel_sort(a, std::less<>(), pool);
+  EXPECT_EQ(0, copy_counted::copies);
+  EXPECT_TRUE(std::is_sorted(a.begin(), a.end()));
+}
+
+TEST(parallel_test, for_each_and_transform) {
+  thread_pool pool(3);
+  vector<uint32_t> a = random_keys(500'000, 2);
+  std::vector<uint32_t> expected = to_std(a);
+
+  parallel_for_each(a, [](uint32_t& x) { x /= 2; }, pool);
+  for (uint32_t& x : expected) {
+    x /= 2;
+  }
+  EXPECT_EQ(expected, to_std(a));
+
+  vector<uint64_t> b;
+  for (size_t i = 0; i < a.size(); ++i) {
+    b.push_back(0);
+  }
+  parallel_transform(a, b, [](uint32_t x) { return uint64_t(x) * x; }, pool);
+  for (size_t i = 0; i < a.size(); ++i) {
+    ASSERT_EQ(uint64_t(a[i]) * a[i], b[i]);
+  }
+
+  vector<uint64_t> c;
+  EXPECT_THROW(parallel_transform(a, c, [](uint32_t x) { return uint64_t(x); }, pool), std::invalid_argument);
+}
+
+TEST(parallel_test, reduce_and_scan) {
+  thread_pool pool(3);
+  vector<uint64_t> a;
+  for (uint64_t i = 1; i <= 1'000'000; ++i) {
+    a.push_back(i);
+  }
+  EXPECT_EQ(500'000'500'000u + 7, parallel_reduce(a, uint64_t(7), std::plus<>(), pool));
+  EXPECT_EQ(7, parallel_reduce(vector<uint64_t>(), uint64_t(7), std::plus<>(), pool));
+
+  // non-commutative: keeps the order of chunks
+  vector<std::string> words;
+  for (int i = 0; i < 100'000; ++i) {
+    words.push_back(std::string(1, static_cast<char>('a' + i % 26)));
+  }
+  std::string joined = parallel_reduce(words, std::string(), std::plus<>(), pool);
+  EXPECT_EQ(std::accumulate(words.begin(), words.end(), std::string()), joined);
+
+  std::vector<uint64_t> expected(a.size());
+  std::inclusive_scan(a.begin(), a.end(), expected.begin());
+  vector<uint64_t> b = a;
+  parallel_inclusive_scan(a, b, std::plus<>(), pool);
+  EXPECT_EQ(expected, to_std(b));
+
+  parallel_inclusive_scan(a, a, std::plus<>(), pool);
+  EXPECT_EQ(expected, to_std(a));
+}
+
+TEST(parallel_test, exception_propagates) {
+  thread_pool pool(3);
+  vector<uint32_t> a = random_keys(500'000, 4);
+  a[400'000] = 0;
+  EXPECT_THROW(parallel_for_each(
+                   a,
+                   [](uint32_t x) {
+                     if (x == 0) {
+                       throw std::runtime_error("zero");
+                     }
+                   },
+                   pool),
+               std::runtime_error);
+}
+
+TEST(parallel_test, nested_algorithms) {
+  thread_pool pool(3);
+  vector<vector<uint32_t>> batches;
+  for (uint32_t i = 0; i < 8; ++i) {
+    batches.push_back(random_keys(100'000, i));
+  }
+  parallel_for_each(batches, [&](vector<uint32_t>& keys) { parallel_sort(keys, std::less<>(), pool); }, pool);
+  for (const vector<uint32_t>& keys : batches) {
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+  }
+}
+
+TEST(parallel_test, no_workers) {
+  thread_pool pool(0);
+  vector<uint32_t> a = random_keys(200'000, 5);
+  std::vector<uint32_t> expected = to_std(a);
+  std::sort(expected.begin(), expected.end());
+  parallel_sort(a, std::less<>(), pool);
+  EXPECT_EQ(expected, to_std(a));
+}
@@ -0,0 +1,256 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "persistent-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+template class persistent_vector<int>;
+template class persistent_vector<std::string>;
+
+namespace {
+
+// counts live instances, to see how many elements the versions hold together
+struct counted {
+  counted(int value)
+      : value(value) {
+    ++live;
+  }
+
+  counted(const counted& other)
+      : value(other.value) {
+    ++live;
+  }
+
+  counted& operator=(const counted& other) = default;
+
+  ~counted() {
+    --live;
+  }
+
+  int value;
+
+  inline static size_t live = 0;
+};
+
+template <typename T>
+std::vector<int> to_ints(const persistent_vector<T>& a) {
+  fault_injection_disable dg;
+  std::vector<int> result;
+  for (size_t i = 0; i < a.size(); ++i) {
+    result.push_back(static_cast<int>(a[i]));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(persistent_vector_test, versions) {
+  element::no_new_instances_guard guard;
+
+  std::mt19937 rng(8);
+  std::vector<persistent_vector<element>> versions(1);
+  std::vector<std::vector<int>> expected(1);
+  for (int i = 0; i < 3000; ++i) {
+    persistent_vector<element> next;
+    std::vector<int> next_expected = expected.back();
+    size_t size = next_expected.size();
+    switch (rng() % 5) {
+    case 0:
+      if (size > 0) {
+        next = versions.back().pop_back();
+        next_expected.pop_back();
+        break;
+      }
+      [[fallthrough]];
+    case 1:
+      if (size > 0) {
+        size_t index = rng() % size;
+        next = versions.back().set(index, i);
+        next_expected[index] = i;
+        break;
+      }
+      [[fallthrough]];
+    default:
+      next = versions.back().push_back(i);
+      next_expected.push_back(i);
+    }
+    versions.push_back(next);
+    expected.push_back(next_expected);
+  }
+
+  for (size_t i = 0; i < versions.size(); ++i) {
+    ASSERT_EQ(expected[i], to_ints(versions[i])) << "version " << i;
+  }
+}
+
+TEST(persistent_vector_test, growth_and_shrink_across_levels) {
+  persistent_vector<int> a;
+  persistent_vector<int>::builder b = a.transient();
+  constexpr int n = 32 * 32 * 32 + 32 * 32 + 33;
+  for (int i = 0; i < n; ++i) {
+    b.push_back(i);
+  }
+  persistent_vector<int> full = b.persistent();
+  EXPECT_TRUE(b.empty());
+  ASSERT_EQ(n, full.size());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(i, full[i]);
+  }
+
+  int next = 0;
+  full.for_each_chunk([&](std::span<const int> chunk) {
+    for (int x : chunk) {
+      ASSERT_EQ(next++, x);
+    }
+  });
+  EXPECT_EQ(n, next);
+
+  persistent_vector<int> shrinking = full;
+  for (int size = n; size > 0; --size) {
+    ASSERT_EQ(size - 1, shrinking[size - 1]);
+    shrinking = shrinking.pop_back();
+  }
+  EXPECT_TRUE(shrinking.empty());
+  EXPECT_EQ(n, full.size());
+  EXPECT_EQ(n - 1, full[n - 1]);
+}
+
+TEST(persistent_vector_test, builder) {
+  element::no_new_instances_guard guard;
+
+  vector<element> initial;
+  for (int i = 0; i < 1000; ++i) {
+    initial.push_back(i);
+  }
+  persistent_vector<element> original(initial);
+  std::vector<int> before = to_ints(original);
+
+  persistent_vector<element>::builder b = original.transient();
+  for (int i = 0; i < 1000; i += 3) {
+    b.set(i, -i);
+  }
+  b.pop_back();
+  b.push_back(7);
+  persistent_vector<element> edited = b.persistent();
+
+  EXPECT_EQ(before, to_ints(original));
+  std::vector<int> after = before;
+  for (int i = 0; i < 1000; i += 3) {
+    after[i] = -i;
+  }
+  after.back() = 7;
+  EXPECT_EQ(after, to_ints(edited));
+
+  vector<element> dense = edited.to_vector();
+  ASSERT_EQ(after.size(), dense.size());
+  for (size_t i = 0; i < dense.size(); ++i) {
+    EXPECT_EQ(after[i], dense[i]);
+  }
+}
+
+TEST(persistent_vector_test, structural_sharing) {
+  constexpr int n = 100'000, edits = 500;
+  {
+    std::mt19937 rng(2);
+    vector<counted> initial;
+    for (int i = 0; i < n; ++i) {
+      initial.push_back(i);
+    }
+    std::vector<persistent_vector<counted>> versions{persistent_vector<counted>(initial)};
+    initial.clear();
+    for (int i = 0; i < edits; ++i) {
+      versions.push_back(versions.back().set(rng() % n, -i));
+    }
+    // every edit copies one leaf of 32 elements
+    EXPECT_LE(counted::live, n + edits * 32);
+    EXPECT_EQ(n, versions.back().size());
+  }
+  EXPECT_EQ(0, counted::live);
+}
+
+TEST(persistent_vector_test, edits_strong) {
+  faulty_run([] {
+    fault_injection_disable dg;
+    persistent_vector<element> a;
+    for (int i = 0; i < 100; ++i) {
+      a = a.push_back(i);
+    }
+    std::vector<int> expected = to_ints(a);
+    dg.reset();
+
+    try {
+      persistent_vector<element> b = a.set(70, 1).push_back(2).pop_back().pop_back().pop_back().pop_back();
+    } catch (...) {
+      EXPECT_EQ(expected, to_ints(a));
+      throw;
+    }
+  });
+}
+
+TEST(persistent_vector_test, builder_strong) {
+  faulty_run([] {
+    fault_injection_disable dg;
+    persistent_vector<element> a;
+    for (int i = 0; i < 96; ++i) {
+      a = a.push_back(i);
+    }
+    // the tail is full and shared, so the next push_back copies its path
+    persistent_vector<element>::builder b = a.transient();
+    b.set(10, -1);
+    std::vector<int> expected = to_ints(a);
+    persistent_vector<element> before = b.persistent();
+    b = before.transient();
+    dg.reset();
+
+    try {
+      b.push_back(b[10]);
+    } catch (...) {
+      EXPECT_EQ(expected, to_ints(a));
+      EXPECT_EQ(to_ints(before), to_ints(b.persistent()));
+      throw;
+    }
+  });
+}
+
+TEST(persistent_vector_performance_test, copy_and_set) {
+  constexpr size_t n = 1'000'000, versions = 1000;
+
+  vector<int> plain;
+  for (size_t i = 0; i < n; ++i) {
+    plain.push_back(static_cast<int>(i));
+  }
+  persistent_vector<int> persistent(plain);
+
+  std::mt19937 rng(9);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<persistent_vector<int>> history{persistent};
+  for (size_t i = 0; i < versions; ++i) {
+    history.push_back(history.back().set(rng() % n, static_cast<int>(i)));
+  }
+  auto persistent_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  size_t checksum = 0;
+  for (size_t i = 0; i < versions / 10; ++i) {
+    vector<int> copy = plain;
+    copy[rng() % n] = static_cast<int>(i);
+    checksum += copy[i];
+  }
+  auto vector_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(n, history.back().size());
+  EXPECT_GT(checksum + 1, 0);
+
+  // a new version copies one path of the tree, a vector all of its elements
+  double persistent_rate = versions / persistent_elapsed;
+  double vector_rate = versions / 10 / vector_elapsed;
+  EXPECT_GT(persistent_rate, 10 * vector_rate);
+
+  RecordProperty("persistent_versions_per_second", std::to_string(static_cast<long long>(persistent_rate)));
+  RecordProperty("vector_copies_per_second", std::to_string(static_cast<long long>(vector_rate)));
+}
@@ -0,0 +1,164 @@
+#include "predicted-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+template class predicted_vector<int>;
+
+namespace {
+
+// Starts every test without learned sites.
+struct predictor_guard {
+  predictor_guard() {
+    capacity_predictor::global().clear();
+  }
+
+  ~predictor_guard() {
+    capacity_predictor::global().clear();
+    capacity_predictor::global().set_learning(true);
+  }
+};
+
+// Returns the number of reallocations while filling a vector built at one call site.
+size_t fill(size_t count) {
+  predicted_vector<int> a;
+  size_t reallocations = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const int* data = a.data();
+    a.push_back(static_cast<int>(i));
+    reallocations += data != a.data();
+  }
+  return reallocations;
+}
+
+} // namespace
+
+TEST(predicted_vector_test, learns_final_size) {
+  predictor_guard guard;
+
+  EXPECT_GT(fill(1000), 5);
+  EXPECT_EQ(0, fill(1000));
+  EXPECT_EQ(0, fill(900));
+
+  // a larger size is picked up at once
+  EXPECT_GT(fill(5000), 0);
+  EXPECT_EQ(0, fill(5000));
+}
+
+TEST(predicted_vector_test, prediction_decays) {
+  predictor_guard guard;
+
+  fill(8000);
+  for (int i = 0; i < 40; ++i) {
+    fill(10);
+  }
+  predicted_vector<int> probe;
+  vector<capacity_hint> hints = capacity_predictor::global().hints();
+  ASSERT_EQ(2, hints.size());
+  EXPECT_LT(hints[0].capacity, 100);
+}
+
+TEST(predicted_vector_test, sites_are_separate) {
+  predictor_guard guard;
+
+  for (int i = 0; i < 2; ++i) {
+    predicted_vector<int> small;
+    predicted_vector<int> large;
+    EXPECT_EQ(i == 0 ? 0 : 10, small.capacity());
+    EXPECT_EQ(i == 0 ? 0 : 1000, large.capacity());
+    for (int j = 0; j < 1000; ++j) {
+      large.push_back(j);
+      if (j < 10) {
+        small.push_back(j);
+      }
+    }
+  }
+}
+
+TEST(predicted_vector_test, moved_from_does_not_report) {
+  predictor_guard guard;
+
+  for (int i = 0; i < 2; ++i) {
+    predicted_vector<int> a;
+    EXPECT_EQ(i == 0 ? 0 : 100, a.capacity());
+    for (int j = 0; j < 100; ++j) {
+      a.push_back(j);
+    }
+    // a is destroyed empty after b and must not drag the prediction down
+    predicted_vector<int> b = std::move(a);
+    EXPECT_EQ(100, b.size());
+  }
+}
+
+TEST(predicted_vector_test, nothrow_move) {
+  static_assert(std::is_nothrow_move_constructible_v<predicted_vector<int>>);
+  static_assert(std::is_nothrow_move_assignable_v<predicted_vector<int>>);
+
+  predictor_guard guard;
+
+  // growth moves the inner vectors instead of copying them
+  vector<predicted_vector<int>> outer;
+  outer.push_back(predicted_vector<int>());
+  outer[0].push_back(1);
+  const int* data = outer[0].data();
+  for (int i = 0; i < 100; ++i) {
+    outer.push_back(predicted_vector<int>());
+  }
+  EXPECT_EQ(data, outer[0].data());
+}
+
+TEST(predicted_vector_test, concurrent_sites) {
+  predictor_guard guard;
+  static constexpr size_t threads = 4;
+
+  std::thread workers[threads];
+  for (size_t t = 0; t < threads; ++t) {
+    workers[t] = std::thread([t] {
+      for (int i = 0; i < 1000; ++i) {
+        fill(100 * (t + 1));
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  // one site, predicting at least the largest recent size
+  vector<capacity_hint> hints = capacity_predictor::global().hints();
+  ASSERT_EQ(1, hints.size());
+  EXPECT_LE(100, hints[0].capacity);
+  EXPECT_GE(100 * threads, hints[0].capacity);
+  EXPECT_EQ(0, fill(100));
+}
+
+TEST(predicted_vector_test, seed_and_write_header) {
+  predictor_guard guard;
+
+  std::source_location site = std::source_location::current();
+  capacity_hint hint{site.file_name(), site.line(), site.column(), 500};
+  capacity_predictor::global().seed({&hint, 1});
+  capacity_predictor::global().set_learning(false);
+
+  {
+    predicted_vector<int> a(site);
+    EXPECT_EQ(500, a.capacity());
+    for (int i = 0; i < 2000; ++i) {
+      a.push_back(i);
+    }
+  }
+  predicted_vector<int> b(site);
+  EXPECT_EQ(500, b.capacity());
+
+  std::ostringstream out;
+  capacity_predictor::global().write_header(out);
+  std::string header = out.str();
+  EXPECT_NE(std::string::npos, header.find("std::array<capacity_hint, 1> vector_capacity_hints"));
+  EXPECT_NE(std::string::npos, header.find(", " + std::to_string(site.line()) + ", "));
+  EXPECT_NE(std::string::npos, header.find(", 500},"));
+}
@@ -0,0 +1,209 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "recycling-policy.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+template class vector<int, recycling_policy>;
+
+namespace {
+
+template <typename T>
+using recycling_vector = vector<T, recycling_policy>;
+
+// Starts every test from an empty cache and the default limit.
+struct recycling_guard {
+  recycling_guard() {
+    recycling_policy::trim();
+  }
+
+  ~recycling_guard() {
+    recycling_policy::trim();
+    recycling_policy::set_cache_limit(size_t(64) << 20);
+  }
+};
+
+template <typename T>
+recycling_vector<T> filled(size_t count) {
+  recycling_vector<T> result;
+  result.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    result.push_back(T());
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(recycling_policy_test, reuses_released_buffer) {
+  recycling_guard guard;
+
+  const int* first;
+  {
+    recycling_vector<int> a;
+    for (int i = 0; i < 100; ++i) {
+      a.push_back(i);
+    }
+    first = a.data();
+  }
+  EXPECT_GT(recycling_policy::cached_bytes(), 0);
+
+  recycling_policy::statistics before = recycling_policy::stats();
+  recycling_vector<int> b;
+  b.reserve(100);
+  EXPECT_EQ(first, b.data());
+  EXPECT_EQ(before.hits + 1, recycling_policy::stats().hits);
+}
+
+TEST(recycling_policy_test, growth_claims_whole_bucket) {
+  recycling_guard guard;
+
+  recycling_vector<int> a;
+  a.push_back(1);
+  EXPECT_EQ(recycling_policy::min_block_size / sizeof(int), a.capacity());
+
+  for (int i = 0; i < 100; ++i) {
+    a.push_back(i);
+  }
+  EXPECT_EQ(512 / sizeof(int), a.capacity());
+}
+
+TEST(recycling_policy_test, reallocation_recycles_old_buffers) {
+  recycling_guard guard;
+
+  recycling_policy::statistics before = recycling_policy::stats();
+  {
+    recycling_vector<int> a;
+    for (int i = 0; i < 1000; ++i) {
+      a.push_back(i);
+    }
+    while (a.size() > 10) {
+      a.pop_back();
+    }
+    a.shrink_to_fit();
+  }
+  recycling_policy::statistics after = recycling_policy::stats();
+  EXPECT_EQ(after.hits + after.misses - before.hits - before.misses, after.recycled - before.recycled);
+
+  // the same growth sequence is now served entirely from the cache
+  recycling_vector<int> b;
+  for (int i = 0; i < 1000; ++i) {
+    b.push_back(i);
+  }
+  EXPECT_EQ(after.misses, recycling_policy::stats().misses);
+}
+
+TEST(recycling_policy_test, cache_limit_and_trim) {
+  recycling_guard guard;
+
+  recycling_policy::set_cache_limit(0);
+  size_t released = recycling_policy::stats().released;
+  {
+    recycling_vector<int> a = filled<int>(100);
+  }
+  EXPECT_EQ(0, recycling_policy::cached_bytes());
+  EXPECT_EQ(released + 1, recycling_policy::stats().released);
+
+  recycling_policy::set_cache_limit(1024);
+  {
+    recycling_vector<int> a = filled<int>(100);
+    recycling_vector<int> b = filled<int>(100);
+    recycling_vector<int> c = filled<int>(100);
+  }
+  EXPECT_EQ(1024, recycling_policy::cached_bytes());
+  EXPECT_EQ(1024, recycling_policy::total_cached_bytes());
+
+  recycling_policy::trim();
+  EXPECT_EQ(0, recycling_policy::cached_bytes());
+  EXPECT_EQ(0, recycling_policy::total_cached_bytes());
+}
+
+TEST(recycling_policy_test, large_and_over_aligned_bypass_cache) {
+  recycling_guard guard;
+
+  {
+    recycling_vector<char> a = filled<char>(recycling_policy::max_block_size + 1);
+    vector<int, aligned_policy<64>> b;
+    b.reserve(100);
+  }
+  EXPECT_EQ(0, recycling_policy::cached_bytes());
+}
+
+TEST(recycling_policy_test, release_on_other_thread) {
+  recycling_guard guard;
+
+  recycling_vector<int> a = filled<int>(100);
+  std::thread([&] {
+    recycling_vector<int> moved = std::move(a);
+    size_t recycled = recycling_policy::stats().recycled;
+    moved = recycling_vector<int>();
+    EXPECT_EQ(recycled + 1, recycling_policy::stats().recycled);
+    EXPECT_EQ(512, recycling_policy::cached_bytes());
+  }).join();
+
+  EXPECT_EQ(0, recycling_policy::cached_bytes());
+  EXPECT_EQ(0, recycling_policy::total_cached_bytes());
+}
+
+TEST(recycling_policy_test, release_after_cache_destroyed) {
+  recycling_guard guard;
+
+  // built before the cache of its thread, so it is destroyed after it
+  std::thread([] {
+    thread_local recycling_vector<int> late;
+    late = filled<int>(100);
+    EXPECT_EQ(1, recycling_policy::stats().misses);
+  }).join();
+  EXPECT_EQ(0, recycling_policy::total_cached_bytes());
+
+  // the same on the main thread, whose cache is gone before statics are destroyed
+  static recycling_vector<int> survivor = filled<int>(100);
+  EXPECT_EQ(100, survivor.size());
+}
+
+TEST(recycling_policy_test, push_back_throw) {
+  element::no_new_instances_guard guard;
+  recycling_guard cache_guard;
+
+  faulty_run([] {
+    recycling_vector<element> a;
+    for (int i = 0; i < 100; ++i) {
+      a.push_back(i);
+    }
+  });
+}
+
+TEST(recycling_policy_performance_test, short_lived_vectors) {
+  recycling_guard guard;
+  static constexpr size_t N = 200'000;
+
+  auto run = [](auto tag) {
+    using vector_type = typename decltype(tag)::type;
+    auto start = std::chrono::steady_clock::now();
+    size_t sum = 0;
+    for (size_t i = 0; i < N; ++i) {
+      vector_type a;
+      for (int j = 0; j < 64; ++j) {
+        a.push_back(j);
+      }
+      sum += a.size();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(N * 64, sum);
+    return static_cast<uint64_t>(N / elapsed);
+  };
+
+  uint64_t plain = run(std::type_identity<vector<int>>());
+  uint64_t recycled = run(std::type_identity<recycling_vector<int>>());
+  recycling_policy::statistics stats = recycling_policy::stats();
+  // after the first vector every growth step is served from the cache
+  EXPECT_GT(stats.hits, 99 * stats.misses);
+  RecordProperty("vector_policy_vectors_per_second", std::to_string(plain));
+  RecordProperty("recycling_policy_vectors_per_second", std::to_string(recycled));
+  RecordProperty("hit_rate_percent", std::to_string(100 * stats.hits / (stats.hits + stats.misses)));
+}
@@ -0,0 +1,255 @@
+#include "devector.h"
+#include "element.h"
+#include "fault-injection.h"
+#include "ring-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Container>
+std::vector<int> to_ints(const Container& a) {
+  fault_injection_disable dg;
+  std::vector<int> result;
+  for (const auto& x : a) {
+    result.push_back(static_cast<int>(x));
+  }
+  return result;
+}
+
+// Random mix of pushes and pops at both ends, mirrored into a std::deque.
+template <typename Container>
+void random_deque_ops(Container& a, std::deque<int>& expected, size_t steps) {
+  std::mt19937 rng(7);
+  for (size_t i = 0; i < steps; ++i) {
+    int value = static_cast<int>(i);
+    switch (rng() % 5) {
+    case 0:
+      a.push_front(value);
+      expected.push_front(value);
+      break;
+    case 1:
+      if (!expected.empty()) {
+        a.pop_front();
+        expected.pop_front();
+      }
+      break;
+    case 2:
+      if (!expected.empty()) {
+        a.pop_back();
+        expected.pop_back();
+      }
+      break;
+    default:
+      a.push_back(value);
+      expected.push_back(value);
+      break;
+    }
+  }
+}
+
+template <typename Container>
+void push_throw_test() {
+  faulty_run([] {
+    fault_injection_disable dg;
+    Container a;
+    for (int i = 0; i < 4; ++i) {
+      a.push_back(i);
+    }
+    std::vector<int> expected = to_ints(a);
+    dg.reset();
+
+    auto check = [&](auto op) {
+      try {
+        op();
+      } catch (...) {
+        fault_injection_disable dg2;
+        EXPECT_EQ(expected, to_ints(a));
+        throw;
+      }
+      expected = to_ints(a);
+    };
+    check([&] { a.push_back(10); });
+    check([&] { a.push_front(11); });
+    check([&] { a.push_front(a.back()); });
+    check([&] { a.push_back(a.front()); });
+  });
+}
+
+// Pops from an empty container are no-ops; oversized reservations throw.
+template <typename Container>
+void empty_and_limits_test() {
+  Container a;
+  a.pop_back();
+  a.pop_front();
+  EXPECT_TRUE(a.empty());
+  a.push_back(1);
+  a.pop_front();
+  a.pop_back();
+  EXPECT_TRUE(a.empty());
+  a.push_back(2);
+  EXPECT_EQ(std::vector<int>{2}, to_ints(a));
+
+  EXPECT_THROW(a.reserve(SIZE_MAX / 2), std::length_error);
+  EXPECT_EQ(std::vector<int>{2}, to_ints(a));
+}
+
+} // namespace
+
+TEST(ring_vector_test, push_pop_both_ends) {
+  element::no_new_instances_guard guard;
+
+  ring_vector<element> a;
+  std::deque<int> expected;
+  random_deque_ops(a, expected, 5000);
+
+  ASSERT_EQ(expected.size(), a.size());
+  EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), to_ints(a));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i], a[i]);
+  }
+}
+
+TEST(ring_vector_test, power_of_two_capacity) {
+  ring_vector<int> a;
+  a.reserve(100);
+  EXPECT_EQ(128, a.capacity());
+
+  for (int i = 0; i < 129; ++i) {
+    a.push_back(i);
+  }
+  EXPECT_EQ(256, a.capacity());
+}
+
+TEST(ring_vector_test, wraps_without_reallocating) {
+  ring_vector<int> a;
+  a.reserve(8);
+  for (int i = 0; i < 8; ++i) {
+    a.push_back(i);
+  }
+  for (int i = 8; i < 1000; ++i) {
+    a.pop_front();
+    a.push_back(i);
+  }
+  EXPECT_EQ(8, a.capacity());
+  EXPECT_EQ(992, a.front());
+  EXPECT_EQ(999, a.back());
+}
+
+TEST(ring_vector_test, copy_and_move) {
+  element::no_new_instances_guard guard;
+
+  ring_vector<element> a;
+  for (int i = 0; i < 50; ++i) {
+    a.push_front(i);
+    a.push_back(i);
+  }
+  ring_vector<element> b = a;
+  EXPECT_EQ(to_ints(a), to_ints(b));
+
+  ring_vector<element> c = std::move(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(to_ints(b), to_ints(c));
+
+  a = c;
+  EXPECT_EQ(to_ints(c), to_ints(a));
+}
+
+TEST(ring_vector_test, push_throw) {
+  element::no_new_instances_guard guard;
+  push_throw_test<ring_vector<element>>();
+}
+
+TEST(ring_vector_test, empty_and_limits) {
+  empty_and_limits_test<ring_vector<int>>();
+}
+
+TEST(ring_vector_test, push_back_moves) {
+  ring_vector<std::unique_ptr<int>> a;
+  for (int i = 0; i < 10; ++i) {
+    auto p = std::make_unique<int>(i);
+    a.push_back(std::move(p));
+    EXPECT_EQ(nullptr, p);
+  }
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, *a[i]);
+  }
+}
+
+TEST(devector_test, push_pop_both_ends) {
+  element::no_new_instances_guard guard;
+
+  devector<element> a;
+  std::deque<int> expected;
+  random_deque_ops(a, expected, 5000);
+
+  ASSERT_EQ(expected.size(), a.size());
+  EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), to_ints(a));
+  EXPECT_EQ(a.data() + a.size(), a.end());
+}
+
+TEST(devector_test, free_space_at_both_ends) {
+  devector<int> a;
+  a.reserve(10);
+  EXPECT_EQ(10, a.capacity());
+  EXPECT_EQ(5, a.front_free());
+  EXPECT_EQ(5, a.back_free());
+
+  for (int i = 0; i < 5; ++i) {
+    a.push_front(i);
+  }
+  EXPECT_EQ(10, a.capacity());
+  EXPECT_EQ(0, a.front_free());
+
+  a.push_front(5);
+  EXPECT_GT(a.front_free(), 0);
+  EXPECT_GT(a.back_free(), 0);
+  EXPECT_EQ((std::vector<int>{5, 4, 3, 2, 1, 0}), to_ints(a));
+}
+
+TEST(devector_test, queue_does_not_grow) {
+  devector<int> a;
+  for (int i = 0; i < 100'000; ++i) {
+    a.push_back(i);
+    if (a.size() > 16) {
+      a.pop_front();
+    }
+  }
+  EXPECT_LE(a.capacity(), 64);
+  EXPECT_EQ(99'999, a.back());
+}
+
+TEST(devector_test, copy_and_move) {
+  element::no_new_instances_guard guard;
+
+  devector<element> a;
+  for (int i = 0; i < 50; ++i) {
+    a.push_front(i);
+    a.push_back(i);
+  }
+  devector<element> b = a;
+  EXPECT_EQ(to_ints(a), to_ints(b));
+
+  devector<element> c = std::move(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(to_ints(b), to_ints(c));
+
+  a = c;
+  EXPECT_EQ(to_ints(c), to_ints(a));
+}
+
+TEST(devector_test, push_throw) {
+  element::no_new_instances_guard guard;
+  push_throw_test<devector<element>>();
+}
+
+TEST(devector_test, empty_and_limits) {
+  empty_and_limits_test<devector<int>>();
+}
@@ -0,0 +1,153 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "rope-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(rope_vector_test, random_edits) {
+  element::no_new_instances_guard guard;
+
+  std::mt19937 rng(4);
+  std::vector<int> expected;
+  rope_vector<element, 8> a;
+  for (int i = 0; i < 20'000; ++i) {
+    if (rng() % 3 == 0 && !expected.empty()) {
+      size_t pos = rng() % expected.size();
+      expected.erase(expected.begin() + pos);
+      a.erase(pos);
+    } else {
+      size_t pos = rng() % (expected.size() + 1);
+      expected.insert(expected.begin() + pos, i);
+      a.insert(pos, i);
+    }
+  }
+
+  ASSERT_EQ(expected.size(), a.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i], a[i]);
+  }
+
+  size_t i = 0;
+  for (const element& x : a) {
+    ASSERT_EQ(expected[i++], x);
+  }
+  EXPECT_EQ(expected.size(), i);
+
+  while (!expected.empty()) {
+    size_t pos = rng() % expected.size();
+    expected.erase(expected.begin() + pos);
+    a.erase(pos);
+    ASSERT_EQ(expected.size(), a.size());
+  }
+  EXPECT_EQ(a.begin(), a.end());
+}
+
+TEST(rope_vector_test, chunks) {
+  rope_vector<int, 16> a;
+  for (int i = 0; i < 1000; ++i) {
+    a.push_back(i);
+  }
+
+  int next = 0;
+  size_t chunks = 0;
+  a.for_each_chunk([&](std::span<const int> chunk) {
+    EXPECT_LE(chunk.size(), 16);
+    for (int x : chunk) {
+      ASSERT_EQ(next++, x);
+    }
+    ++chunks;
+  });
+  EXPECT_EQ(1000, next);
+  EXPECT_LE(1000 / 16, chunks);
+}
+
+TEST(rope_vector_test, occupancy_after_erases) {
+  static constexpr size_t chunk = 16;
+
+  std::vector<int> expected;
+  rope_vector<int, chunk> a;
+  for (int i = 0; i < 20'000; ++i) {
+    expected.push_back(i);
+    a.push_back(i);
+  }
+
+  std::mt19937 rng(6);
+  while (expected.size() > 100) {
+    // erasing every other element of a stretch thins out several neighbouring chunks at once
+    size_t pos = rng() % expected.size();
+    for (size_t j = 0; j < 50 && pos < expected.size(); ++j, ++pos) {
+      expected.erase(expected.begin() + pos);
+      a.erase(pos);
+    }
+
+    size_t chunks = 0;
+    size_t next = 0;
+    a.for_each_chunk([&](std::span<const int> c) {
+      EXPECT_LE(c.size(), chunk);
+      EXPECT_GE(c.size(), chunk / 4);
+      for (int x : c) {
+        ASSERT_EQ(expected[next++], x);
+      }
+      ++chunks;
+    });
+    ASSERT_EQ(expected.size(), next);
+    ASSERT_GE(expected.size() / (chunk / 4), chunks);
+  }
+}
+
+TEST(rope_vector_test, erase_throw) {
+  element::no_new_instances_guard guard;
+
+  faulty_run([] {
+    fault_injection_disable dg;
+    rope_vector<element, 8> a;
+    for (int i = 0; i < 200; ++i) {
+      a.push_back(i);
+    }
+    dg.reset();
+
+    try {
+      for (size_t i = 0; i < 50; ++i) {
+        a.erase(i * 7 % a.size());
+      }
+    } catch (...) {
+      // the elements of one chunk may be garbled, but the tree is intact
+      fault_injection_disable dg2;
+      size_t count = 0;
+      a.for_each_chunk([&](std::span<const element> chunk) { count += chunk.size(); });
+      EXPECT_EQ(a.size(), count);
+      throw;
+    }
+  });
+
+  rope_vector<int> empty;
+  empty.erase(0);
+  EXPECT_TRUE(empty.empty());
+}
+
+TEST(rope_vector_test, copy_and_move) {
+  rope_vector<std::string> a;
+  for (int i = 0; i < 500; ++i) {
+    a.insert(i / 2, std::to_string(i));
+  }
+
+  rope_vector<std::string> b = a;
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    ASSERT_EQ(a[i], b[i]);
+  }
+  b[0] = "changed";
+  EXPECT_NE(a[0], b[0]);
+
+  rope_vector<std::string> c = std::move(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(500, c.size());
+
+  a = c;
+  EXPECT_EQ(500, a.size());
+}
@@ -0,0 +1,172 @@
+#include "shm-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#ifdef VECTOR_HAVE_SHARED_MEMORY
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sys/wait.h>
+
+template class shm_vector<int>;
+template class shm_vector<double>;
+
+namespace {
+
+std::string segment_name(const char* test) {
+  return "/shm_vector_test." + std::to_string(::getpid()) + "." + test;
+}
+
+} // namespace
+
+TEST(shm_vector_test, named_segment) {
+  std::string name = segment_name("named");
+  shm_vector<int> writer = shm_vector<int>::create(name.c_str(), 1000);
+  EXPECT_THROW(shm_vector<int>::create(name.c_str(), 1000), std::system_error);
+  shm_vector<int> reader = shm_vector<int>::open(name.c_str());
+  shm_vector<int>::unlink(name.c_str());
+  EXPECT_TRUE(writer.writable());
+  EXPECT_FALSE(reader.writable());
+  EXPECT_EQ(1000, reader.max_capacity());
+
+  for (int i = 0; i < 100; ++i) {
+    writer.push_back(i * i);
+  }
+  writer.set(3, -1);
+  writer.pop_back();
+  EXPECT_EQ(99, reader.size());
+  EXPECT_EQ(-1, reader[3]);
+  EXPECT_EQ(98 * 98, reader[98]);
+  EXPECT_EQ(0, reader.generation() % 2);
+
+  vector<int> copy = reader.snapshot();
+  ASSERT_EQ(99, copy.size());
+  EXPECT_EQ(0, std::memcmp(copy.data(), writer.data(), 99 * sizeof(int)));
+
+  EXPECT_THROW(reader.push_back(1), std::logic_error);
+  EXPECT_THROW(reader.pop_back(), std::logic_error);
+  EXPECT_THROW(reader.clear(), std::logic_error);
+  EXPECT_THROW(reader.set(0, 1), std::logic_error);
+  EXPECT_THROW(writer.set(99, 1), std::out_of_range);
+  EXPECT_EQ(99, reader.size());
+  EXPECT_THROW(shm_vector<double>::open(writer.fd()), std::runtime_error);
+  EXPECT_THROW(shm_vector<int>::open(name.c_str()), std::system_error);
+}
+
+TEST(shm_vector_test, capacity_limit) {
+  shm_vector<int> a = shm_vector<int>::create_anonymous(100);
+  for (int i = 0; i < 100; ++i) {
+    a.push_back(i);
+  }
+  EXPECT_EQ(100, a.capacity());
+  uint64_t generation = a.generation();
+  EXPECT_THROW(a.push_back(100), std::length_error);
+  EXPECT_THROW(a.reserve(101), std::length_error);
+  EXPECT_EQ(100, a.size());
+  EXPECT_EQ(generation, a.generation());
+
+  vector<int> values;
+  values.push_back(7);
+  a.assign(values.view());
+  EXPECT_EQ(1, a.size());
+  a.clear();
+  EXPECT_TRUE(a.empty());
+
+  // popping an empty vector leaves it empty instead of wrapping the size
+  generation = a.generation();
+  a.pop_back();
+  EXPECT_EQ(0, a.size());
+  EXPECT_EQ(generation, a.generation());
+  a.push_back(1);
+  EXPECT_EQ(1, a.size());
+}
+
+TEST(shm_vector_test, readers_see_whole_write_sections) {
+  constexpr size_t n = 4096;
+  shm_vector<uint64_t> writer = shm_vector<uint64_t>::create_anonymous(n);
+  shm_vector<uint64_t> reader = shm_vector<uint64_t>::open(writer.fd());
+  for (size_t i = 0; i < n; ++i) {
+    writer.push_back(0);
+  }
+
+  std::atomic<bool> done{false};
+  std::thread t([&] {
+    for (uint64_t round = 1; round <= 2000; ++round) {
+      writer.modify([&](std::span<uint64_t> values) {
+        for (uint64_t& value : values) {
+          value = round;
+        }
+      });
+      // leave gaps between the sections for the reader to succeed in
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    done = true;
+  });
+
+  size_t consistent = 0;
+  while (!done) {
+    uint64_t first = 0;
+    bool uniform = true;
+    bool ok = reader.try_read([&](std::span<const uint64_t> values) {
+      first = values[0];
+      for (uint64_t value : values) {
+        uniform &= value == first;
+      }
+    });
+    if (ok) {
+      ASSERT_TRUE(uniform) << "torn read accepted at " << first;
+      ++consistent;
+    }
+  }
+  t.join();
+  vector<uint64_t> last = reader.snapshot();
+  EXPECT_EQ(2000, last[0]);
+  EXPECT_EQ(2000, last[n - 1]);
+  EXPECT_GT(consistent, 0);
+}
+
+TEST(shm_vector_test, other_process) {
+  shm_vector<int> writer = shm_vector<int>::create_anonymous(1 << 20);
+  pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    // the child maps the inherited descriptor and waits for the full vector
+    int status = 1;
+    try {
+      shm_vector<int> reader = shm_vector<int>::open(writer.fd());
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (std::chrono::steady_clock::now() < deadline) {
+        long long sum = -1;
+        bool ok = reader.try_read([&](std::span<const int> values) {
+          if (values.size() == 1000) {
+            sum = std::accumulate(values.begin(), values.end(), 0ll);
+          }
+        });
+        if (ok && sum >= 0) {
+          status = sum == 999 * 1000 / 2 ? 0 : 2;
+          break;
+        }
+      }
+    } catch (...) {
+      status = 3;
+    }
+    ::_exit(status);
+  }
+
+  for (int i = 0; i < 1000; ++i) {
+    writer.push_back(i);
+  }
+  int status = 0;
+  ASSERT_EQ(child, ::waitpid(child, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+#endif
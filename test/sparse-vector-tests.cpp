@@ -0,0 +1,240 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "sparse-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+template class sparse_vector<int>;
+template class sparse_vector<std::string>;
+
+namespace {
+
+template <typename T>
+void expect_matches(const sparse_vector<T>& a, const std::vector<T>& expected) {
+  ASSERT_EQ(expected.size(), a.size());
+  size_t stored = 0;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i], a[i]) << "index " << i;
+    ASSERT_EQ(expected[i] != a.default_value(), a.contains(i)) << "index " << i;
+    stored += a.contains(i);
+  }
+  ASSERT_EQ(stored, a.nnz());
+  ASSERT_TRUE(std::is_sorted(a.indices().begin(), a.indices().end()));
+}
+
+} // namespace
+
+TEST(sparse_vector_test, random_set_and_reset) {
+  static constexpr size_t N = 5000;
+
+  sparse_vector<int> a(N);
+  std::vector<int> expected(N);
+  std::mt19937 rng(3);
+  for (size_t step = 0; step < 20'000; ++step) {
+    size_t index = rng() % N;
+    int value = rng() % 3 == 0 ? 0 : static_cast<int>(rng() % 100);
+    if (rng() % 4 == 0) {
+      a.reset(index);
+      expected[index] = 0;
+    } else {
+      a.set(index, value);
+      expected[index] = value;
+    }
+  }
+  expect_matches(a, expected);
+}
+
+TEST(sparse_vector_test, push_pop_resize) {
+  sparse_vector<int> a;
+  std::vector<int> expected;
+  for (int i = 0; i < 3000; ++i) {
+    int value = i % 7 == 0 ? i : 0;
+    a.push_back(value);
+    expected.push_back(value);
+  }
+  expect_matches(a, expected);
+
+  for (int i = 0; i < 700; ++i) {
+    a.pop_back();
+    expected.pop_back();
+  }
+  expect_matches(a, expected);
+
+  a.resize(1000);
+  expected.resize(1000);
+  expect_matches(a, expected);
+
+  a.resize(4000);
+  expected.resize(4000);
+  a.set(3999, 5);
+  expected[3999] = 5;
+  expect_matches(a, expected);
+
+  a.clear();
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(0, a.nnz());
+}
+
+TEST(sparse_vector_test, dense_round_trip) {
+  vector<std::string> dense;
+  for (int i = 0; i < 1000; ++i) {
+    dense.push_back(i % 100 == 3 ? std::to_string(i) : "-");
+  }
+
+  sparse_vector<std::string> a(dense, "-");
+  EXPECT_EQ(10, a.nnz());
+  EXPECT_EQ("103", a[103]);
+  EXPECT_EQ("-", a[104]);
+  EXPECT_EQ(203, a.indices()[2]);
+  EXPECT_EQ("203", a.values()[2]);
+  EXPECT_TRUE(a.to_dense() == dense);
+
+  sparse_vector<std::string> b;
+  b = a;
+  a.set(103, "-");
+  EXPECT_EQ(9, a.nnz());
+  EXPECT_EQ(10, b.nnz());
+  EXPECT_TRUE(b.to_dense() == dense);
+}
+
+TEST(sparse_vector_test, moved_from) {
+  sparse_vector<int> a(1000);
+  a.set(10, 1);
+  a.set(900, 2);
+
+  sparse_vector<int> b = std::move(a);
+  EXPECT_EQ(1000, b.size());
+  EXPECT_EQ(2, b[900]);
+  EXPECT_EQ(0, a.size());
+  EXPECT_EQ(0, a.nnz());
+
+  // the moved-from vector is empty and usable
+  a.push_back(5);
+  a.push_back(0);
+  ASSERT_EQ(2, a.size());
+  EXPECT_EQ(5, a[0]);
+  EXPECT_TRUE(a.contains(0));
+  EXPECT_FALSE(a.contains(1));
+
+  sparse_vector<int> c(10);
+  c = std::move(b);
+  EXPECT_EQ(1000, c.size());
+  EXPECT_EQ(1, c[10]);
+  EXPECT_EQ(0, b.size());
+  b.resize(600);
+  EXPECT_EQ(0, b[599]);
+  EXPECT_FALSE(b.contains(599));
+}
+
+TEST(sparse_vector_test, set_strong) {
+  faulty_run([] {
+    fault_injection_disable dg;
+    sparse_vector<element> a(2000, element(0));
+    for (size_t i = 0; i < 2000; i += 97) {
+      a.set(i, element(static_cast<int>(i) + 1));
+    }
+    vector<element> expected = a.to_dense();
+    dg.reset();
+
+    try {
+      a.set(500, element(7));
+      a.set(1999, element(8));
+      a.push_back(element(9));
+    } catch (...) {
+      fault_injection_disable dg2;
+      vector<element> actual = a.to_dense();
+      EXPECT_TRUE(actual.size() == expected.size() || actual.size() == expected.size() + 1);
+      EXPECT_EQ(2000, a.size());
+      throw;
+    }
+  });
+}
+
+TEST(sparse_vector_test, reset_keeps_arrays_in_step) {
+  faulty_run([] {
+    fault_injection_disable dg;
+    sparse_vector<element> a(2000, element(0));
+    for (size_t i = 0; i < 2000; i += 97) {
+      a.set(i, element(static_cast<int>(i) + 1));
+    }
+    dg.reset();
+
+    try {
+      a.reset(97);
+    } catch (...) {
+      fault_injection_disable dg2;
+      EXPECT_EQ(a.indices().size(), a.values().size());
+      EXPECT_TRUE(a.contains(97));
+      throw;
+    }
+    fault_injection_disable dg2;
+    EXPECT_EQ(a.indices().size(), a.values().size());
+    EXPECT_FALSE(a.contains(97));
+  });
+}
+
+TEST(sparse_vector_test, pop_back_empty) {
+  sparse_vector<int> a;
+  a.pop_back();
+  EXPECT_EQ(0, a.size());
+  a.push_back(3);
+  a.pop_back();
+  a.pop_back();
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(0, a.nnz());
+}
+
+TEST(sparse_vector_performance_test, scan_and_memory) {
+  static constexpr size_t N = 10'000'000, NNZ = 50'000;
+
+  std::mt19937 rng(9);
+  sparse_vector<double> sparse(N);
+  vector<double> dense;
+  dense.reserve(N);
+  for (size_t i = 0; i < N; ++i) {
+    dense.push_back(0);
+  }
+  for (size_t i = 0; i < NNZ; ++i) {
+    size_t index = rng() % N;
+    sparse.set(index, 1.0);
+    dense[index] = 1.0;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  double sparse_sum = 0;
+  for (double x : sparse.values()) {
+    sparse_sum += x;
+  }
+  auto sparse_time = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  double dense_sum = 0;
+  for (double x : dense) {
+    dense_sum += x;
+  }
+  auto dense_time = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(dense_sum, sparse_sum);
+
+  start = std::chrono::steady_clock::now();
+  size_t hits = 0;
+  for (size_t i = 0; i < 1'000'000; ++i) {
+    hits += sparse.contains(rng() % N);
+  }
+  auto lookup_time = std::chrono::steady_clock::now() - start;
+  EXPECT_GT(hits, 0);
+
+  using us = std::chrono::microseconds;
+  EXPECT_LT(sparse.memory_usage(), N * sizeof(double) / 10);
+  RecordProperty("sparse_bytes", std::to_string(sparse.memory_usage()));
+  RecordProperty("dense_bytes", std::to_string(dense.capacity() * sizeof(double)));
+  RecordProperty("sparse_scan_us", std::to_string(std::chrono::duration_cast<us>(sparse_time).count()));
+  RecordProperty("dense_scan_us", std::to_string(std::chrono::duration_cast<us>(dense_time).count()));
+  RecordProperty("contains_per_second",
+                 std::to_string(static_cast<long long>(1e6 / std::chrono::duration<double>(lookup_time).count())));
+}
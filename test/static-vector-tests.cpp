@@ -0,0 +1,190 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "static-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+template class static_vector<int, 8>;
+template class static_vector<std::string, 8>;
+
+static_assert(std::is_trivially_copyable_v<static_vector<int, 8>>);
+static_assert(std::is_trivially_destructible_v<static_vector<int, 8>>);
+static_assert(!std::is_trivially_copyable_v<static_vector<std::string, 8>>);
+static_assert(sizeof(static_vector<int, 8>) == sizeof(size_t) + 8 * sizeof(int));
+static_assert(alignof(static_vector<double, 3>) == alignof(double));
+
+namespace {
+
+constexpr int constexpr_ops() {
+  static_vector<int, 8> a;
+  for (int i = 0; i < 5; ++i) {
+    a.push_back(i);
+  }
+  a.erase(a.begin() + 1);
+  a.insert(a.begin(), 10);
+  a.pop_back();
+
+  static_vector<int, 8> b = a;
+  int sum = 0;
+  for (int x : b) {
+    sum = sum * 10 + x;
+  }
+  return sum;
+}
+
+static_assert(constexpr_ops() == 10023);
+
+template <typename Container>
+std::vector<int> to_ints(const Container& a) {
+  fault_injection_disable dg;
+  std::vector<int> result;
+  for (const auto& x : a) {
+    result.push_back(static_cast<int>(x));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(static_vector_test, random_ops) {
+  element::no_new_instances_guard guard;
+
+  static_vector<element, 32> a;
+  std::vector<int> expected;
+  std::mt19937 rng(5);
+  for (int i = 0; i < 5000; ++i) {
+    size_t pos = expected.empty() ? 0 : rng() % (expected.size() + 1);
+    switch (rng() % 4) {
+    case 0:
+      if (expected.size() < a.capacity()) {
+        a.push_back(i);
+        expected.push_back(i);
+      }
+      break;
+    case 1:
+      if (expected.size() < a.capacity()) {
+        a.insert(a.begin() + pos, i);
+        expected.insert(expected.begin() + pos, i);
+      }
+      break;
+    case 2:
+      if (pos < expected.size()) {
+        a.erase(a.begin() + pos);
+        expected.erase(expected.begin() + pos);
+      }
+      break;
+    case 3:
+      if (!expected.empty()) {
+        a.pop_back();
+        expected.pop_back();
+      }
+      break;
+    }
+    ASSERT_EQ(expected, to_ints(a));
+  }
+}
+
+TEST(static_vector_test, overflow_throws) {
+  element::no_new_instances_guard guard;
+
+  static_vector<element, 3> a;
+  for (int i = 0; i < 3; ++i) {
+    a.push_back(i);
+  }
+  EXPECT_THROW(a.push_back(3), std::length_error);
+  EXPECT_THROW(a.insert(a.begin(), 3), std::length_error);
+  EXPECT_THROW(a.reserve(4), std::length_error);
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), to_ints(a));
+
+  a.reserve(3);
+  a.shrink_to_fit();
+  EXPECT_EQ(3, a.capacity());
+}
+
+TEST(static_vector_test, precondition_mode) {
+  static_vector<int, 2, static_vector_overflow::precondition> a;
+  a.push_back(1);
+  a.insert(a.begin(), 0);
+  EXPECT_EQ(0, a.front());
+  EXPECT_EQ(1, a.back());
+  EXPECT_EQ(2, a.size());
+}
+
+#ifndef NDEBUG
+TEST(static_vector_test, pop_back_empty_asserts) {
+  static_vector<int, 2> a;
+  EXPECT_DEATH(a.pop_back(), "");
+}
+#endif
+
+TEST(static_vector_test, insert_own_element) {
+  static_vector<std::string, 4> a;
+  a.push_back("a");
+  a.push_back("b");
+  a.insert(a.begin(), a.back());
+  a.insert(a.end(), a.front());
+  EXPECT_EQ((std::vector<std::string>{"b", "a", "b", "b"}), std::vector<std::string>(a.begin(), a.end()));
+}
+
+TEST(static_vector_test, copy_move_swap) {
+  element::no_new_instances_guard guard;
+
+  static_vector<element, 8> a;
+  static_vector<element, 8> b;
+  for (int i = 0; i < 5; ++i) {
+    a.push_back(i);
+  }
+  b.push_back(42);
+
+  static_vector<element, 8> c = a;
+  EXPECT_EQ(to_ints(a), to_ints(c));
+
+  a.swap(b);
+  EXPECT_EQ((std::vector<int>{42}), to_ints(a));
+  EXPECT_EQ(to_ints(c), to_ints(b));
+
+  a = std::move(b);
+  EXPECT_EQ(to_ints(c), to_ints(a));
+  b = a;
+  a.erase(a.begin() + 1, a.begin() + 4);
+  EXPECT_EQ((std::vector<int>{0, 4}), to_ints(a));
+  EXPECT_EQ(to_ints(c), to_ints(b));
+}
+
+TEST(static_vector_test, trivially_copyable_bulk_copy) {
+  static_vector<int, 16> a;
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(i * i);
+  }
+
+  static_vector<int, 16> b;
+  std::memcpy(&b, &a, sizeof(a));
+  EXPECT_EQ(to_ints(a), to_ints(b));
+}
+
+TEST(static_vector_test, push_back_strong) {
+  faulty_run([] {
+    fault_injection_disable dg;
+    static_vector<element, 8> a;
+    for (int i = 0; i < 4; ++i) {
+      a.push_back(i);
+    }
+    std::vector<int> expected = to_ints(a);
+    dg.reset();
+
+    try {
+      a.push_back(a.front());
+    } catch (...) {
+      EXPECT_EQ(expected, to_ints(a));
+      throw;
+    }
+  });
+}
@@ -5,13 +5,22 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <compare>
+#include <random>
 #include <sstream>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 template class vector<int>;
 template class vector<element>;
 template class vector<std::string>;
 template class vector<ordered_element>;
+template class vector<int, aligned_policy<64>>;
+template class vector<element, shrinking_policy<>>;
+template class vector<element, compact_policy<>>;
+template class vector<element, fallback_growth_policy<vector_policy, 50, 25>>;
 
 namespace {
 
@@ -120,6 +129,17 @@ class exception_safety_test : public base_test {};
 
 class performance_test : public base_test {};
 
+struct alignas(64) over_aligned {
+  over_aligned(int value)
+      : value(value) {}
+
+  int value;
+};
+
+bool is_aligned(const void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
 } // namespace
 
 TEST_F(correctness_test, default_ctor) {
@@ -879,6 +899,56 @@ TEST_F(correctness_test, insert_xvalue_reallocation_noexcept) {
   ASSERT_LE(element::get_copy_counter(), 501);
 }
 
+namespace {
+
+struct default_element : element {
+  using element::element;
+
+  default_element()
+      : element(0) {}
+};
+
+} // namespace
+
+TEST_F(correctness_test, resize) {
+  static constexpr size_t N = 500;
+
+  vector<default_element> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(2 * i + 1);
+  }
+  a.resize(N / 2);
+  EXPECT_EQ(N / 2, a.size());
+  EXPECT_EQ(N - 1, a.back());
+
+  a.resize(2 * N);
+  EXPECT_EQ(2 * N, a.size());
+  for (size_t i = 0; i < 2 * N; ++i) {
+    ASSERT_EQ(i < N / 2 ? 2 * i + 1 : 0, a[i]);
+  }
+
+  vector<int> b;
+  b.resize(N);
+  EXPECT_EQ(N, b.size());
+  EXPECT_EQ(0, b[N - 1]);
+}
+
+TEST_F(exception_safety_test, resize_throw) {
+  static constexpr size_t N = 10;
+
+  faulty_run([] {
+    fault_injection_disable dg;
+    vector<default_element> a;
+    for (size_t i = 0; i < N; ++i) {
+      a.push_back(2 * i + 1);
+    }
+    dg.reset();
+
+    strong_exception_safety_guard sg(a);
+    a.resize(3 * N);
+  });
+}
+
 TEST_F(correctness_test, erase) {
   static constexpr size_t N = 500;
 
@@ -1124,6 +1194,7 @@ TEST_F(exception_safety_test, copy_assign_throw) {
     dg.reset();
 
     strong_exception_safety_guard sg(a);
+    strong_exception_safety_guard sg_b(b);
     b = std::as_const(a);
   });
 }
@@ -1158,3 +1229,685 @@ TEST_F(correctness_test, member_aliases) {
   EXPECT_TRUE((std::is_same<element*, vector<element>::iterator>::value));
   EXPECT_TRUE((std::is_same<const element*, vector<element>::const_iterator>::value));
 }
+
+TEST_F(correctness_test, over_aligned_storage) {
+  static constexpr size_t N = 500;
+
+  vector<over_aligned> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(2 * i + 1);
+    ASSERT_TRUE(is_aligned(a.data(), alignof(over_aligned)));
+  }
+
+  a.reserve(2 * N);
+  EXPECT_TRUE(is_aligned(a.data(), alignof(over_aligned)));
+
+  a.shrink_to_fit();
+  EXPECT_TRUE(is_aligned(a.data(), alignof(over_aligned)));
+
+  vector<over_aligned> b = a;
+  EXPECT_TRUE(is_aligned(b.data(), alignof(over_aligned)));
+
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(2 * i + 1, b[i].value);
+  }
+}
+
+TEST_F(correctness_test, aligned_vector) {
+  static constexpr size_t N = 500;
+
+  aligned_vector<int, 64> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(2 * i + 1);
+    ASSERT_TRUE(is_aligned(a.data(), 64));
+  }
+
+  a.insert(a.begin() + N / 2, 42);
+  EXPECT_TRUE(is_aligned(a.data(), 64));
+  EXPECT_EQ(42, a[N / 2]);
+
+  aligned_vector<char, 128> b;
+  b.reserve(3);
+  EXPECT_TRUE(is_aligned(b.data(), 128));
+}
+
+#ifdef VECTOR_HAVE_MALLOC_USABLE_SIZE
+TEST_F(correctness_test, malloc_policy) {
+  static constexpr size_t N = 500;
+
+  vector<element, malloc_policy> a;
+  a.push_back(1);
+  EXPECT_EQ(malloc_usable_size(a.data()) / sizeof(element), a.capacity());
+  for (size_t i = 1; i < N; ++i) {
+    a.push_back(2 * i + 1);
+  }
+  vector<element, malloc_policy> b = a;
+  a.clear();
+  a.shrink_to_fit();
+  for (size_t i = 1; i < N; ++i) {
+    ASSERT_EQ(2 * i + 1, b[i]);
+  }
+
+  vector<over_aligned, malloc_policy> c;
+  for (size_t i = 0; i < N; ++i) {
+    c.push_back(i);
+    ASSERT_TRUE(is_aligned(c.data(), alignof(over_aligned)));
+  }
+}
+
+namespace {
+
+template <typename T>
+size_t count_reallocations(size_t n) {
+  vector<T, malloc_policy> a;
+  size_t reallocations = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const T* old_data = a.data();
+    a.push_back(T(i));
+    reallocations += old_data != a.data();
+  }
+  return reallocations;
+}
+
+} // namespace
+
+TEST_F(performance_test, push_back_reallocations) {
+  static constexpr size_t N = 1'000'000;
+
+  size_t doubling = 1;
+  while ((size_t(2) << doubling) < N) {
+    ++doubling;
+  }
+
+  // glibc rounds small blocks up, and the capacity claimed from that slack
+  // compounds through every later doubling
+  size_t r1 = count_reallocations<char>(N);
+  size_t r4 = count_reallocations<int>(N);
+  size_t r8 = count_reallocations<size_t>(N);
+  EXPECT_LT(r1, doubling + 1);
+  EXPECT_LT(r4, doubling + 1);
+  EXPECT_LT(r8, doubling + 1);
+
+  RecordProperty("doubling", static_cast<int>(doubling + 1));
+  RecordProperty("reallocations_1", static_cast<int>(r1));
+  RecordProperty("reallocations_4", static_cast<int>(r4));
+  RecordProperty("reallocations_8", static_cast<int>(r8));
+}
+#endif
+
+TEST_F(correctness_test, auto_shrink_pop_back) {
+  static constexpr size_t N = 10'000;
+
+  vector<element, shrinking_policy<>> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(i);
+  }
+  size_t peak = a.capacity();
+
+  while (a.size() > peak / 4) {
+    a.pop_back();
+    ASSERT_EQ(peak, a.capacity());
+  }
+  a.pop_back();
+  EXPECT_LT(a.capacity(), 2 * a.size() + 16);
+  EXPECT_GE(a.capacity(), 2 * a.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    ASSERT_EQ(i, a[i]);
+  }
+
+  vector<element> b;
+  for (size_t i = 0; i < N; ++i) {
+    b.push_back(i);
+  }
+  size_t b_capacity = b.capacity();
+  while (!b.empty()) {
+    b.pop_back();
+  }
+  EXPECT_EQ(b_capacity, b.capacity());
+}
+
+TEST_F(correctness_test, auto_shrink_hysteresis) {
+  vector<int, shrinking_policy<>> a;
+  for (int i = 0; i < 10'000; ++i) {
+    a.push_back(i);
+  }
+  while (a.size() >= a.capacity() / 4) {
+    a.pop_back();
+  }
+
+  // right after a shrink, and at the edge of the next growth
+  for (int round = 0; round < 2; ++round) {
+    const int* data = a.data();
+    for (int i = 0; i < 1000; ++i) {
+      a.push_back(i);
+      a.pop_back();
+      a.pop_back();
+      a.push_back(i);
+    }
+    EXPECT_EQ(data, a.data());
+    while (a.size() < a.capacity()) {
+      a.push_back(0);
+    }
+    a.pop_back();
+  }
+}
+
+TEST_F(correctness_test, auto_shrink_erase_clear) {
+  vector<int, shrinking_policy<>> a;
+  for (int i = 0; i < 10'000; ++i) {
+    a.push_back(i);
+  }
+  a.erase(a.begin() + 10, a.end() - 10);
+  EXPECT_EQ(20, a.size());
+  EXPECT_LE(a.capacity(), 1024 / sizeof(int) * 2);
+  EXPECT_EQ(9'999, a.back());
+
+  for (int i = 0; i < 10'000; ++i) {
+    a.push_back(i);
+  }
+  a.clear();
+  EXPECT_EQ(0, a.capacity());
+  a.push_back(1);
+  EXPECT_EQ(1, a.back());
+
+  vector<int, shrinking_policy<>> small;
+  for (int i = 0; i < 100; ++i) {
+    small.push_back(i);
+  }
+  size_t capacity = small.capacity();
+  small.clear();
+  EXPECT_EQ(capacity, small.capacity());
+}
+
+TEST_F(correctness_test, header_size) {
+  EXPECT_EQ(3 * sizeof(void*), sizeof(vector<int>));
+  EXPECT_EQ(16, sizeof(compact_vector<int>));
+  EXPECT_EQ(16, sizeof(compact_vector<std::string>));
+}
+
+TEST_F(correctness_test, compact_vector) {
+  static constexpr size_t N = 5000;
+
+  compact_vector<element> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(i);
+  }
+  a.insert(a.begin() + 10, 42);
+  a.erase(a.begin() + 20, a.begin() + 30);
+  ASSERT_EQ(N - 9, a.size());
+  EXPECT_EQ(42, a[10]);
+  EXPECT_EQ(30, a[21]);
+
+  compact_vector<element> b = a;
+  EXPECT_EQ(a.size(), b.size());
+  b.shrink_to_fit();
+  EXPECT_EQ(b.size(), b.capacity());
+}
+
+TEST_F(correctness_test, compact_vector_limit) {
+  compact_vector<char, uint8_t> a;
+  EXPECT_EQ(255, a.max_size());
+  for (int i = 0; i < 255; ++i) {
+    a.push_back(static_cast<char>(i));
+  }
+  // growth is capped at the limit even when the allocator hands out more
+  EXPECT_EQ(255, a.capacity());
+
+  EXPECT_THROW(a.push_back('x'), std::length_error);
+  EXPECT_EQ(255, a.size());
+  EXPECT_EQ(static_cast<char>(254), a.back());
+
+  compact_vector<char, uint8_t> b;
+  EXPECT_THROW(b.reserve(256), std::length_error);
+  EXPECT_EQ(0, b.capacity());
+}
+
+#ifdef VECTOR_HAVE_POSIX_IO
+
+TEST_F(correctness_test, append_from_fd) {
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+
+  std::string message = "hello, vector";
+  ASSERT_EQ(message.size(), ::write(fds[1], message.data(), message.size()));
+
+  vector<char> a;
+  a.push_back('>');
+  EXPECT_EQ(5, a.append_from_fd(fds[0], 5));
+  EXPECT_EQ(6, a.size());
+  EXPECT_EQ(message.size() - 5, a.append_from_fd(fds[0], 100));
+  EXPECT_EQ(">" + message, std::string(a.begin(), a.end()));
+
+  ::close(fds[1]);
+  EXPECT_EQ(0, a.append_from_fd(fds[0], 100));
+  EXPECT_EQ(message.size() + 1, a.size());
+  ::close(fds[0]);
+
+  EXPECT_THROW(a.append_from_fd(-1, 10), std::system_error);
+  EXPECT_EQ(message.size() + 1, a.size());
+}
+
+TEST_F(correctness_test, append_from_fd_large_max) {
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+
+  std::string message = "hello, vector";
+  ASSERT_EQ(message.size(), ::write(fds[1], message.data(), message.size()));
+
+  vector<char> a;
+  EXPECT_EQ(message.size(), a.append_from_fd(fds[0], SIZE_MAX));
+  EXPECT_EQ(message, std::string(a.begin(), a.end()));
+  EXPECT_GT(size_t(1) << 20, a.capacity());
+
+  ASSERT_EQ(message.size(), ::write(fds[1], message.data(), message.size()));
+  EXPECT_EQ(message.size(), a.append_from_fd(fds[0], size_t(1) << 30));
+  EXPECT_EQ(2 * message.size(), a.size());
+  EXPECT_GT(size_t(1) << 20, a.capacity());
+
+  compact_vector<char, uint8_t> b;
+  ASSERT_EQ(message.size(), ::write(fds[1], message.data(), message.size()));
+  EXPECT_THROW(b.append_from_fd(fds[0], 1000), std::length_error);
+  EXPECT_EQ(0, b.size());
+  EXPECT_EQ(message.size(), b.append_from_fd(fds[0], 100));
+  EXPECT_EQ(message, std::string(b.begin(), b.end()));
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST_F(correctness_test, read_all) {
+  static constexpr size_t N = 100'000;
+
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(nullptr, file);
+  int fd = ::fileno(file);
+
+  std::string content;
+  for (size_t i = 0; i < N; ++i) {
+    content.push_back(static_cast<char>('a' + i % 26));
+  }
+  ASSERT_EQ(N, ::write(fd, content.data(), N));
+
+  vector<std::byte> a;
+  EXPECT_EQ(0, a.read_all(fd));
+  EXPECT_EQ(0, a.size());
+  ASSERT_EQ(0, ::lseek(fd, 0, SEEK_SET));
+
+  EXPECT_EQ(N, a.read_all(fd));
+  ASSERT_EQ(N, a.size());
+  EXPECT_LE(N, a.capacity());
+  EXPECT_GT(2 * N, a.capacity());
+  EXPECT_EQ(0, std::memcmp(content.data(), a.data(), N));
+
+  vector<char> b;
+  EXPECT_EQ(N / 2, b.append_from_fd(fd, N / 2, N / 2));
+  EXPECT_EQ(content.substr(N / 2), std::string(b.begin(), b.end()));
+
+  std::fclose(file);
+}
+
+TEST_F(exception_safety_test, read_all_throw) {
+  static constexpr size_t N = 20'000;
+  std::string content(N, 'x');
+
+  faulty_run([&] {
+    fault_injection_disable dg;
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    ASSERT_EQ(N, ::write(fds[1], content.data(), N));
+    ::close(fds[1]);
+    vector<char> a;
+    a.push_back('a');
+    const char* data = a.data();
+    size_t capacity = a.capacity();
+    dg.reset();
+
+    try {
+      a.read_all(fds[0]);
+    } catch (...) {
+      fault_injection_disable dg2;
+      EXPECT_EQ(data, a.data());
+      EXPECT_EQ(capacity, a.capacity());
+      EXPECT_EQ(1, a.size());
+      ::close(fds[0]);
+      throw;
+    }
+    ::close(fds[0]);
+    EXPECT_EQ(N + 1, a.size());
+  });
+}
+
+#endif
+
+TEST_F(correctness_test, comparison) {
+  vector<int> a;
+  vector<int> b;
+  EXPECT_TRUE(a == b);
+  EXPECT_EQ(std::strong_ordering::equal, a <=> b);
+
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(i);
+    b.push_back(i);
+  }
+  EXPECT_TRUE(a == b);
+  b.back() = -1;
+  EXPECT_TRUE(a != b);
+  EXPECT_TRUE(b < a);
+  b.pop_back();
+  EXPECT_TRUE(b < a);
+  EXPECT_TRUE(a > b);
+
+  // memcmp ordering of bytes matches element-wise ordering
+  vector<unsigned char> c;
+  vector<unsigned char> d;
+  c.push_back(1);
+  d.push_back(200);
+  EXPECT_TRUE(c < d);
+  c.push_back(0);
+  d.pop_back();
+  EXPECT_TRUE(d < c);
+
+  // element-wise fallback, across policies
+  vector<std::string> e;
+  vector<std::string, aligned_policy<64>> f;
+  e.push_back("a");
+  f.push_back("a");
+  EXPECT_TRUE(e == f);
+  f.push_back("");
+  EXPECT_TRUE(e < f);
+}
+
+namespace {
+
+enum class color : uint8_t { red, green };
+
+struct point {
+  int32_t x, y;
+
+  bool operator==(const point&) const = default;
+};
+
+} // namespace
+
+template <>
+inline constexpr bool enable_trivially_comparable<point> = true;
+
+static_assert(trivially_comparable<uint32_t>);
+static_assert(trivially_comparable<color>);
+static_assert(trivially_comparable<point>);
+static_assert(!trivially_comparable<double>);
+static_assert(!trivially_comparable<std::string>);
+
+TEST_F(correctness_test, hash) {
+  std::hash<vector<uint32_t>> hash;
+  vector<uint32_t> a;
+  vector<uint32_t> b;
+  EXPECT_EQ(hash(a), hash(b));
+  a.push_back(0);
+  EXPECT_NE(hash(a), hash(b));
+  b.push_back(0);
+  EXPECT_EQ(hash(a), hash(b));
+
+  vector<point> p;
+  p.push_back({1, 2});
+  vector<point> q = p;
+  EXPECT_TRUE(p == q);
+  EXPECT_EQ(std::hash<vector<point>>()(p), std::hash<vector<point>>()(q));
+
+  std::unordered_set<vector<std::string>> strings;
+  vector<std::string> s;
+  for (int i = 0; i < 100; ++i) {
+    s.push_back(std::to_string(i));
+    strings.insert(s);
+  }
+  EXPECT_EQ(100, strings.size());
+  EXPECT_EQ(1, strings.count(s));
+}
+
+static_assert(std::is_nothrow_move_constructible_v<vector<element>>);
+static_assert(std::is_nothrow_move_assignable_v<vector<element>>);
+static_assert(std::is_nothrow_swappable_v<vector<element>>);
+static_assert(trivially_relocatable<int>);
+static_assert(trivially_relocatable<vector<element>>);
+static_assert(!trivially_relocatable<element>);
+
+TEST_F(correctness_test, swap) {
+  vector<element> a;
+  vector<element> b;
+  for (size_t i = 0; i < 10; ++i) {
+    a.push_back(i);
+  }
+  b.push_back(42);
+  const element* a_data = a.data();
+
+  element::reset_counters();
+  a.swap(b);
+  EXPECT_EQ(0, element::get_copy_counter());
+  EXPECT_EQ(1, a.size());
+  EXPECT_EQ(42, a[0]);
+  EXPECT_EQ(10, b.size());
+  EXPECT_EQ(a_data, b.data());
+
+  using std::swap;
+  swap(a, b);
+  EXPECT_EQ(10, a.size());
+  EXPECT_EQ(42, b[0]);
+}
+
+namespace {
+
+// vector_policy that tracks the bytes it has handed out
+struct counting_policy : vector_policy {
+  inline static size_t live_bytes = 0;
+  inline static size_t allocations = 0;
+
+  static void* allocate(size_t& bytes, size_t alignment) {
+    void* ptr = vector_policy::allocate(bytes, alignment);
+    live_bytes += bytes;
+    ++allocations;
+    return ptr;
+  }
+
+  static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+    live_bytes -= bytes;
+    vector_policy::deallocate(ptr, bytes, alignment);
+  }
+};
+
+} // namespace
+
+TEST_F(exception_safety_test, push_back_first_allocation_throw) {
+  faulty_run([] {
+    vector<element, counting_policy> a;
+    element x = 1;
+    try {
+      a.push_back(x);
+    } catch (...) {
+      EXPECT_EQ(0, a.capacity());
+      EXPECT_EQ(0, counting_policy::live_bytes);
+      throw;
+    }
+  });
+  EXPECT_EQ(0, counting_policy::live_bytes);
+}
+
+TEST_F(correctness_test, auto_shrink_copy_assign) {
+  vector<int, shrinking_policy<counting_policy>> a;
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(i);
+  }
+  vector<int, shrinking_policy<counting_policy>> b;
+  for (int i = 0; i < 10'000; ++i) {
+    b.push_back(i);
+  }
+
+  // one buffer for the copy, none for shrinking the old contents first
+  size_t allocations = counting_policy::allocations;
+  b = a;
+  EXPECT_EQ(allocations + 1, counting_policy::allocations);
+  EXPECT_EQ(a, b);
+}
+
+TEST_F(correctness_test, nested_vector_growth) {
+  static constexpr size_t N = 1000;
+
+  vector<vector<element>> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(vector<element>());
+    a.back().push_back(i);
+    a.back().push_back(i + 1);
+  }
+
+  // growth relocates the inner headers, the elements stay where they are
+  const element* first = a[0].data();
+  element::reset_counters();
+  a.reserve(4 * N);
+  a.push_back(vector<element>());
+  a.insert(a.begin(), vector<element>());
+  a.shrink_to_fit();
+  EXPECT_EQ(0, element::get_copy_counter());
+  EXPECT_EQ(0, element::get_move_counter());
+
+  ASSERT_EQ(N + 2, a.size());
+  EXPECT_EQ(first, a[1].data());
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(2, a[i + 1].size());
+    ASSERT_EQ(i, a[i + 1][0]);
+  }
+}
+
+namespace {
+
+// the vector as it was before moves were noexcept: containers copy it on growth
+struct deep_copied_vector : vector<int> {
+  deep_copied_vector() = default;
+  deep_copied_vector(const deep_copied_vector&) = default;
+  deep_copied_vector(deep_copied_vector&& other) noexcept(false)
+      : vector<int>(std::move(other)) {}
+};
+
+} // namespace
+
+TEST_F(performance_test, nested_vector_growth) {
+  static constexpr size_t N = 1000, M = 16, R = 2000;
+
+  // time only the reallocations: the outer buffer of N inner vectors is
+  // moved once per round, small enough to be reused from the heap rather
+  // than faulted in
+  auto measure = [](auto outer) {
+    typename decltype(outer)::value_type inner;
+    for (size_t j = 0; j < M; ++j) {
+      inner.push_back(static_cast<int>(j));
+    }
+    std::chrono::duration<double> elapsed{0};
+    for (size_t r = 0; r < R; ++r) {
+      outer = decltype(outer)();
+      for (size_t i = 0; i < N; ++i) {
+        outer.push_back(inner);
+      }
+      auto start = std::chrono::steady_clock::now();
+      outer.reserve(outer.capacity() + 1);
+      elapsed += std::chrono::steady_clock::now() - start;
+      EXPECT_EQ(M, outer.back().size());
+    }
+    return N * R / elapsed.count();
+  };
+
+  double relocated = measure(vector<vector<int>>());
+  double moved = measure(std::vector<vector<int>>());
+  double deep_copied = measure(std::vector<deep_copied_vector>());
+  // a relocation is a memcpy of the headers, a deep copy allocates per element
+  EXPECT_GT(relocated, 2 * deep_copied);
+
+  RecordProperty("relocated_per_second", std::to_string(static_cast<long long>(relocated)));
+  RecordProperty("moved_per_second", std::to_string(static_cast<long long>(moved)));
+  RecordProperty("deep_copied_per_second", std::to_string(static_cast<long long>(deep_copied)));
+}
+
+namespace {
+
+// vector_policy refusing blocks above max_bytes, as an allocator near its limit
+struct capped_policy : vector_policy {
+  inline static size_t max_bytes = 0;
+
+  static void* allocate(size_t& bytes, size_t alignment) {
+    if (bytes > max_bytes) {
+      throw std::bad_alloc();
+    }
+    return vector_policy::allocate(bytes, alignment);
+  }
+};
+
+template <typename Policy>
+size_t fill_until_bad_alloc() {
+  vector<int, Policy> a;
+  try {
+    for (int i = 0;; ++i) {
+      a.push_back(i);
+    }
+  } catch (const std::bad_alloc&) {
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(i, a[i]);
+  }
+  return a.size();
+}
+
+} // namespace
+
+TEST_F(correctness_test, growth_fallback) {
+  capped_policy::max_bytes = 3000;
+  size_t doubling = fill_until_bad_alloc<capped_policy>();
+  size_t stepped = fill_until_bad_alloc<fallback_growth_policy<capped_policy, 50, 25>>();
+  size_t exact = fill_until_bad_alloc<fallback_growth_policy<capped_policy>>();
+
+  // doubling gives up once twice the capacity is too much, the fallbacks get
+  // within one allocation granule of the cap
+  size_t cap = capped_policy::max_bytes / sizeof(int);
+  EXPECT_LE(doubling, cap);
+  EXPECT_GT(stepped, doubling);
+  EXPECT_GE(stepped, cap - 16);
+  EXPECT_GE(exact, cap - 16);
+}
+
+TEST_F(exception_safety_test, push_back_growth_fallback) {
+  faulty_run_allowing_recovery([] {
+    fault_injection_disable dg;
+    vector<element, fallback_growth_policy<vector_policy, 50, 25>> a;
+    while (a.size() < 8 || a.size() < a.capacity()) {
+      a.push_back(static_cast<int>(a.size()));
+    }
+    std::vector<int> expected(a.begin(), a.end());
+    dg.reset();
+
+    try {
+      a.push_back(a[0]);
+    } catch (...) {
+      expect_eq(a, expected);
+      throw;
+    }
+    expected.push_back(0);
+    expect_eq(a, expected);
+  });
+}
+
+TEST_F(exception_safety_test, insert_growth_fallback) {
+  faulty_run_allowing_recovery([] {
+    fault_injection_disable dg;
+    vector<element, fallback_growth_policy<vector_policy, 50, 25>> a;
+    while (a.size() < 8 || a.size() < a.capacity()) {
+      a.push_back(static_cast<int>(a.size()));
+    }
+    std::vector<int> expected(a.begin(), a.end());
+    dg.reset();
+
+    try {
+      a.insert(a.begin() + 3, a.back());
+    } catch (...) {
+      expect_eq(a, expected);
+      throw;
+    }
+    expected.insert(expected.begin() + 3, expected.back());
+    expect_eq(a, expected);
+  });
+}
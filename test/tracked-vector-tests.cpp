@@ -0,0 +1,175 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "tracked-vector.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+template class tracked_vector<int>;
+template class tracked_vector<std::string>;
+
+TEST(tracked_vector_test, coalescing) {
+  vector<int> initial;
+  for (int i = 0; i < 100; ++i) {
+    initial.push_back(i);
+  }
+  tracked_vector<int> a(initial);
+  EXPECT_EQ((std::vector<dirty_range>{{0, 100}}), std::vector<dirty_range>(a.dirty().begin(), a.dirty().end()));
+  a.take_changes();
+  EXPECT_TRUE(a.dirty().empty());
+
+  a[10] = -1;
+  a[12] = -1;
+  a[11] = -1;
+  a.mark_dirty(50, 5);
+  a.mark_dirty(55);
+  a.mark_dirty(40, 2);
+  a.modify(30, 3)[0] = -2;
+  EXPECT_EQ(-1, a[11]);
+  EXPECT_EQ(-2, a[30]);
+  EXPECT_EQ((std::vector<dirty_range>{{10, 13}, {30, 33}, {40, 42}, {50, 56}}),
+            std::vector<dirty_range>(a.dirty().begin(), a.dirty().end()));
+
+  // one range spanning everything in between swallows them
+  a.mark_dirty(12, 30);
+  EXPECT_EQ((std::vector<dirty_range>{{10, 42}, {50, 56}}), std::vector<dirty_range>(a.dirty().begin(), a.dirty().end()));
+
+  tracked_changes<int> changes = a.take_changes();
+  EXPECT_EQ(100, changes.size);
+  ASSERT_EQ(2, changes.ranges.size());
+  EXPECT_EQ(10, changes.ranges[0].first);
+  EXPECT_EQ(32, changes.ranges[0].values.size());
+  EXPECT_EQ(a.data() + 50, changes.ranges[1].values.data());
+}
+
+TEST(tracked_vector_test, structural_changes) {
+  tracked_vector<int> a;
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(i);
+  }
+  a.take_changes();
+
+  a.insert(5, 42);
+  EXPECT_EQ((std::vector<dirty_range>{{5, 11}}), std::vector<dirty_range>(a.dirty().begin(), a.dirty().end()));
+  a.take_changes();
+
+  a[1] = 7;
+  a.erase(8, 3);
+  a.erase(3);
+  EXPECT_EQ(7, a.size());
+  EXPECT_EQ((std::vector<dirty_range>{{1, 2}, {3, 7}}), std::vector<dirty_range>(a.dirty().begin(), a.dirty().end()));
+
+  a.pop_back();
+  a.pop_back();
+  a.pop_back();
+  EXPECT_EQ((std::vector<dirty_range>{{1, 2}, {3, 4}}), std::vector<dirty_range>(a.dirty().begin(), a.dirty().end()));
+
+  a.clear();
+  tracked_changes<int> changes = a.take_changes();
+  EXPECT_EQ(0, changes.size);
+  EXPECT_TRUE(changes.ranges.empty());
+}
+
+TEST(tracked_vector_test, erase_throw) {
+  faulty_run([] {
+    fault_injection_disable dg;
+    tracked_vector<element> a;
+    for (int i = 0; i < 10; ++i) {
+      a.push_back(i);
+    }
+    a.take_changes();
+    dg.reset();
+
+    try {
+      a.erase(3, 2);
+    } catch (...) {
+      // every element the failed shift has overwritten is still reported
+      fault_injection_disable dg2;
+      std::vector<bool> dirty(a.size());
+      for (const dirty_range& r : a.dirty()) {
+        for (size_t i = r.first; i < r.last; ++i) {
+          dirty[i] = true;
+        }
+      }
+      for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_TRUE(dirty[i] || a.values()[i] == static_cast<int>(i));
+      }
+      throw;
+    }
+  });
+}
+
+TEST(tracked_vector_test, replication) {
+  tracked_vector<std::string> a;
+  vector<std::string> replica;
+  std::mt19937 rng(13);
+  for (int round = 0; round < 200; ++round) {
+    for (int step = 0; step < 20; ++step) {
+      std::string value = std::to_string(rng() % 1000);
+      size_t index = a.empty() ? 0 : rng() % a.size();
+      switch (rng() % 6) {
+      case 0:
+      case 1:
+        a.push_back(value);
+        break;
+      case 2:
+        a.insert(index, value);
+        break;
+      case 3:
+        if (!a.empty()) {
+          a.erase(index, std::min<size_t>(1 + rng() % 3, a.size() - index));
+        }
+        break;
+      case 4:
+        if (!a.empty()) {
+          a.pop_back();
+        }
+        break;
+      default:
+        if (!a.empty()) {
+          a[index] = value;
+        }
+      }
+    }
+    apply_changes(replica, a.take_changes());
+    ASSERT_TRUE(replica == a.values()) << "round " << round;
+  }
+}
+
+TEST(tracked_vector_performance_test, sparse_updates) {
+  static constexpr size_t N = 1'000'000, W = 1000, R = 100;
+
+  vector<int> initial;
+  for (size_t i = 0; i < N; ++i) {
+    initial.push_back(static_cast<int>(i));
+  }
+  tracked_vector<int> a(initial);
+  vector<int> replica;
+  apply_changes(replica, a.take_changes());
+
+  std::mt19937 rng(5);
+  size_t sent = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < R; ++r) {
+    for (size_t w = 0; w < W; ++w) {
+      a[rng() % N] = static_cast<int>(w);
+    }
+    tracked_changes<int> changes = a.take_changes();
+    for (const auto& range : changes.ranges) {
+      sent += sizeof(size_t) + range.values.size() * sizeof(int);
+    }
+    apply_changes(replica, changes);
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_TRUE(replica == a.values());
+  EXPECT_LT(sent, R * N * sizeof(int) / 100);
+
+  RecordProperty("tracked_bytes_sent", std::to_string(sent));
+  RecordProperty("full_bytes_sent", std::to_string(R * N * sizeof(int)));
+  RecordProperty("tracked_writes_per_second", std::to_string(static_cast<long long>(R * W / elapsed)));
+}
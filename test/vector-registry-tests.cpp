@@ -0,0 +1,116 @@
+#include "vector-registry.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <poll.h>
+
+template class registered_vector<int>;
+template class registered_vector<std::string>;
+
+static_assert(std::is_nothrow_move_constructible_v<registered_vector<std::string>>);
+
+namespace {
+
+template <typename T>
+registered_vector<T> make(size_t size, size_t capacity) {
+  registered_vector<T> result;
+  result.reserve(capacity);
+  for (size_t i = 0; i < size; ++i) {
+    result.push_back(T());
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(vector_registry_test, registration) {
+  vector_registry& registry = vector_registry::global();
+  size_t before = registry.instances();
+  {
+    registered_vector<int> a;
+    a.push_back(1);
+    EXPECT_EQ(before + 1, registry.instances());
+
+    registered_vector<int> b = a;
+    registered_vector<int> c = std::move(a);
+    EXPECT_EQ(before + 3, registry.instances());
+
+    std::vector<registered_vector<int>> many(100);
+    EXPECT_EQ(before + 103, registry.instances());
+    many.resize(1000);
+    EXPECT_EQ(before + 1003, registry.instances());
+
+    b = c;
+    a = std::move(c);
+    EXPECT_EQ(before + 1003, registry.instances());
+    EXPECT_EQ(1, a.size());
+  }
+  EXPECT_EQ(before, registry.instances());
+}
+
+TEST(vector_registry_test, report) {
+  ASSERT_EQ(0, vector_registry::global().instances());
+
+  registered_vector<int> ints = make<int>(10, 1000);
+  registered_vector<int> full_ints = make<int>(2000, 0);
+  full_ints.shrink_to_fit();
+  registered_vector<double> doubles = make<double>(100, 100);
+  registered_vector<int> empty;
+
+  vector_report report = vector_registry::global().report(2);
+  EXPECT_EQ(4, report.instances);
+  size_t bytes = ints.capacity() * sizeof(int) + full_ints.capacity() * sizeof(int) + doubles.capacity() * sizeof(double);
+  size_t slack = (ints.capacity() - 10) * sizeof(int) + (full_ints.capacity() - 2000) * sizeof(int) +
+                 (doubles.capacity() - 100) * sizeof(double);
+  EXPECT_EQ(bytes, report.bytes);
+  EXPECT_EQ(slack, report.slack_bytes);
+
+  ASSERT_EQ(2, report.types.size());
+  EXPECT_NE(std::string::npos, std::string(report.types[0].type).find("vector<int"));
+  EXPECT_EQ(3, report.types[0].instances);
+  EXPECT_EQ(1, report.types[1].instances);
+
+  ASSERT_EQ(2, report.largest.size());
+  EXPECT_EQ(static_cast<const void*>(&full_ints), report.largest[0].address);
+  EXPECT_EQ(static_cast<const void*>(&ints), report.largest[1].address);
+  ASSERT_EQ(2, report.most_wasteful.size());
+  EXPECT_EQ(static_cast<const void*>(&ints), report.most_wasteful[0].address);
+  EXPECT_EQ((ints.capacity() - 10) * sizeof(int), report.most_wasteful[0].slack_bytes);
+
+  std::ostringstream out;
+  report.write(out);
+  EXPECT_NE(std::string::npos, out.str().find("vectors: 4"));
+  EXPECT_NE(std::string::npos, out.str().find("most wasteful:"));
+}
+
+TEST(vector_registry_test, dump_on_signal) {
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+  registered_vector<int> a = make<int>(3, 64);
+
+  // a failed install leaves nothing behind and can be retried
+  EXPECT_THROW(vector_registry::dump_on_signal(SIGKILL, fds[1]), std::system_error);
+  vector_registry::dump_on_signal(SIGUSR1, fds[1]);
+  EXPECT_THROW(vector_registry::dump_on_signal(SIGUSR2, fds[1]), std::logic_error);
+  std::raise(SIGUSR1);
+
+  std::string text;
+  pollfd p{fds[0], POLLIN, 0};
+  while (text.find("most wasteful:") == std::string::npos && ::poll(&p, 1, 5000) > 0) {
+    char buffer[4096];
+    ssize_t n = ::read(fds[0], buffer, sizeof(buffer));
+    ASSERT_GT(n, 0);
+    text.append(buffer, static_cast<size_t>(n));
+  }
+  EXPECT_NE(std::string::npos, text.find("vectors: 1"));
+  EXPECT_NE(std::string::npos, text.find("size 3, capacity "));
+  ::close(fds[0]);
+}
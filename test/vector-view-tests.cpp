@@ -0,0 +1,146 @@
+#include "vector-view.h"
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+template class vector_view<int>;
+template class vector_view<const int>;
+
+namespace {
+
+struct base {
+  int value;
+};
+
+struct derived : base {
+  int extra;
+};
+
+int sum(vector_view<const int> values) {
+  return std::accumulate(values.begin(), values.end(), 0);
+}
+
+int sum_span(std::span<const int> values) {
+  return std::accumulate(values.begin(), values.end(), 0);
+}
+
+vector<int> iota(int count) {
+  vector<int> result;
+  for (int i = 0; i < count; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(vector_view_test, view_and_subview) {
+  vector<int> a = iota(10);
+
+  vector_view<int> v = a.view(2, 5);
+  ASSERT_EQ(5, v.size());
+  EXPECT_EQ(a.data() + 2, v.data());
+  EXPECT_EQ(2, v.front());
+  EXPECT_EQ(6, v.back());
+
+  vector_view<int> s = v.subview(1, 2);
+  EXPECT_EQ(3, s[0]);
+  EXPECT_EQ(4, s[1]);
+  EXPECT_EQ(2, s.size());
+
+  // count is clamped, first past the end throws
+  EXPECT_EQ(3, v.subview(2).size());
+  EXPECT_EQ(0, v.subview(5).size());
+  EXPECT_EQ(8, a.view(2).size());
+  EXPECT_THROW(v.subview(6), std::out_of_range);
+  EXPECT_THROW(a.view(11, 1), std::out_of_range);
+
+  // writes go to the vector
+  s[0] = 42;
+  EXPECT_EQ(42, a[3]);
+}
+
+TEST(vector_view_test, const_conversions) {
+  vector<int> a = iota(10);
+  const vector<int>& ca = a;
+
+  EXPECT_EQ(45, sum(a));
+  EXPECT_EQ(45, sum(ca));
+  EXPECT_EQ(45, sum(a.view()));
+  EXPECT_EQ(10, sum(ca.view(1, 4)));
+
+  std::vector<int> b = {1, 2, 3};
+  EXPECT_EQ(6, sum(b));
+
+  int raw[] = {4, 5, 6};
+  EXPECT_EQ(15, sum(vector_view<const int>(raw, 3)));
+
+  static_assert(std::is_convertible_v<vector_view<int>, vector_view<const int>>);
+  static_assert(!std::is_convertible_v<vector_view<const int>, vector_view<int>>);
+  static_assert(!std::is_convertible_v<const vector<int>&, vector_view<int>>);
+  // an owning temporary would dangle
+  static_assert(!std::is_convertible_v<vector<int>&&, vector_view<const int>>);
+  // a view of derived elements as base would step with the wrong stride
+  static_assert(!std::is_convertible_v<vector<derived>&, vector_view<const base>>);
+  static_assert(!std::is_convertible_v<std::span<derived>, vector_view<base>>);
+  static_assert(std::is_trivially_copyable_v<vector_view<int>>);
+}
+
+TEST(vector_view_test, span_interop) {
+  vector<int> a = iota(10);
+  vector_view<int> v = a.view(5);
+
+  std::span<int> s = v;
+  EXPECT_EQ(v.data(), s.data());
+  EXPECT_EQ(v.size(), s.size());
+  EXPECT_EQ(35, sum_span(v.span()));
+
+  vector_view<int> back = s.subspan(1);
+  EXPECT_EQ(4, back.size());
+  EXPECT_EQ(6, back[0]);
+
+  vector_view deduced = a;
+  static_assert(std::is_same_v<decltype(deduced), vector_view<int>>);
+}
+
+TEST(vector_view_test, at_and_checked_access) {
+  vector<int> a = iota(3);
+  vector_view<const int> v = a.view();
+  EXPECT_EQ(2, v.at(2));
+  EXPECT_THROW(v.at(3), std::out_of_range);
+
+#if defined(VECTOR_VIEW_CHECKED) || !defined(NDEBUG)
+  EXPECT_THROW(v[3], std::out_of_range);
+  EXPECT_THROW(v.subview(3).front(), std::out_of_range);
+  EXPECT_THROW(vector_view<int>().back(), std::out_of_range);
+#endif
+}
+
+TEST(vector_view_test, tokens_without_copies) {
+  std::string text = "let x = 42 ;";
+  vector<char> buffer;
+  for (char c : text) {
+    buffer.push_back(c);
+  }
+
+  vector<vector_view<const char>> tokens;
+  const vector<char>& input = buffer;
+  size_t start = 0;
+  for (size_t i = 0; i <= input.size(); ++i) {
+    if (i == input.size() || input[i] == ' ') {
+      tokens.push_back(input.view(start, i - start));
+      start = i + 1;
+    }
+  }
+
+  ASSERT_EQ(5, tokens.size());
+  EXPECT_EQ("x", std::string(tokens[1].begin(), tokens[1].end()));
+  EXPECT_EQ("42", std::string(tokens[3].begin(), tokens[3].end()));
+  EXPECT_EQ(buffer.data() + 8, tokens[3].data());
+}